@@ -0,0 +1,45 @@
+#ifndef CHUNKER_H
+#define CHUNKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* A contiguous region of a buffer */
+struct chunk {
+    size_t offset;
+    size_t length;
+};
+
+/**
+ * @brief Content-defined chunking with FastCDC.
+ *
+ * Cut points are chosen by a gear rolling hash over the data itself, so
+ * an insertion or deletion only changes the chunks around it and the
+ * rest of the file splits into the same chunks as before. Chunks are at
+ * least @p min_size bytes and at most @p max_size bytes (the last chunk
+ * of a buffer may be shorter). Normalized chunking keeps most chunks
+ * close to @p avg_size, which is rounded down to a power of two.
+ *
+ * The gear table is fixed at compile time, so cut points are stable
+ * across runs and builds.
+ */
+class Chunker {
+public:
+    Chunker(size_t min_size, size_t avg_size, size_t max_size);
+
+    /* Length of the chunk starting at @p data, given @p len bytes left */
+    size_t next(const uint8_t* data, size_t len) const;
+
+    /* Split a whole buffer into chunks */
+    std::vector<chunk> split(const uint8_t* data, size_t len) const;
+
+private:
+    size_t min_size;
+    size_t avg_size;
+    size_t max_size;
+    uint64_t mask_small;
+    uint64_t mask_large;
+};
+
+#endif // CHUNKER_H
@@ -0,0 +1,25 @@
+#ifndef FILE_CLIENT_H
+#define FILE_CLIENT_H
+
+#include "parser_client.h"
+
+/* Fingerprint a file or a directory tree (args.path).
+ *
+ * Every regular file is split into content-defined chunks (see
+ * chunker.h) between args.smin and args.smax bytes. Files are processed
+ * by args.jobs worker threads, each file over its own connection with
+ * one HashRequest per chunk. Chunks found in the manifest cache
+ * (args.manifest, if given) are not sent again, and the cache is
+ * updated afterwards. The cache is first bound to the server by hashing
+ * a fixed probe chunk; entries from another server or salt are dropped.
+ *
+ * For every file a chunk manifest is printed to stdout:
+ *   <path>: <chunks> chunks, <sent> sent
+ *     <index>: <offset> <length> 0x<digest>
+ *
+ * Returns 0 if every file was hashed, 1 otherwise. Errors for single
+ * files are reported on stderr and do not stop the other files.
+ */
+int hash_path(const client_arguments& args);
+
+#endif // FILE_CLIENT_H
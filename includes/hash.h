@@ -11,11 +11,26 @@ struct checksum_ctx;
 
 #define UPDATE_PAYLOAD_SIZE 4096
 
+/* Digest algorithms understood by the checksum API. Every algorithm
+ * produces a 32 byte digest, so the wire format of HashResponse does
+ * not depend on the choice. The numeric values are sent in InitRequest
+ * and must not change. */
+enum class HashAlgorithm : uint32_t {
+	SHA256     = 0,
+	SHA512_256 = 1,
+	BLAKE2s256 = 2
+};
+
 /* This takes an initial salt and salt length and returns a context
  * that can be used with the other functions. If len is 0, salt can be
  * NULL. Returns NULL on error */
 struct checksum_ctx * checksum_create(const uint8_t *salt, size_t len);
 
+/* Same as checksum_create, but the context computes the digest with
+ * the given algorithm. checksum_create is equivalent to passing
+ * HashAlgorithm::SHA256. Returns NULL on error or unknown algorithm */
+struct checksum_ctx * checksum_create_alg(const uint8_t *salt, size_t len, HashAlgorithm alg);
+
 /* With a valid context, add the payload to the hash. Payload must
  * have a length of 4096 bytes. Repeated calls of update will let you
  * compute the hash incrementally (4096 bytes at a time). Function
@@ -23,6 +38,13 @@ struct checksum_ctx * checksum_create(const uint8_t *salt, size_t len);
  */
 int checksum_update(struct checksum_ctx *, const uint8_t *payload);
 
+/* With a valid context, add a payload of arbitrary length to the
+ * hash. Unlike checksum_update this does not require full 4096 byte
+ * blocks, which makes it suitable for feeding partial socket reads.
+ * Returns 0 on success.
+ */
+int checksum_append(struct checksum_ctx *, const uint8_t *payload, size_t len);
+
 /* With a valid context, add the payload (with a specified length) to
  * the current hash and output the full checksum into out. out must
  * have enough space to write 32 bytes of output. Function returns 0
@@ -0,0 +1,89 @@
+#ifndef HASH_SERVICE_H
+#define HASH_SERVICE_H
+
+#include "hash.h"
+#include "session.h"
+#include "timer_wheel.h"
+#include "watchdog.h"
+#include "worker_pool.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <span>
+#include <string>
+#include <thread>
+
+/* Configuration of a HashService */
+struct service_options {
+    std::string salt;                              // salt for every digest (may be empty)
+    size_t workers = 0;                            // workers kept when idle, 0 = one per core
+    deadline_settings deadlines;                   // deadlines for network sessions
+    std::chrono::seconds resume_ttl{60};           // retention of interrupted batches, 0 = off
+    size_t resume_window = 1024;                   // digests retained per resumable batch
+    size_t resume_parked = 256;                    // interrupted batches retained at once, oldest dropped first
+};
+
+/**
+ * @brief The hashing service behind the server, usable in-process.
+ *
+ * In-process callers submit byte spans and get the salted digest through
+ * a future or a callback. The network front-end hands accepted sockets to
+ * serve(), which runs the wire protocol (deadlines, resumable batches,
+ * tracing) on the same worker threads. Salt handling is the checksum API
+ * from hash.cpp in both cases, so a span submitted here gets the same
+ * digest as the same bytes sent over TCP.
+ *
+ * Destroying the service waits for every submitted job and served
+ * connection to finish.
+ */
+class HashService {
+public:
+    using Digest = std::array<uint8_t, 32>;
+    using Callback = std::function<void(const Digest& digest, std::exception_ptr error)>;
+
+    explicit HashService(service_options options);
+    ~HashService() = default;
+
+    HashService(const HashService&) = delete;
+    HashService& operator=(const HashService&) = delete;
+
+    /* Hash @p data on a worker. The bytes must stay valid until the
+     * future is ready. Errors are delivered through the future. */
+    std::future<Digest> submit(std::span<const uint8_t> data, HashAlgorithm algorithm = HashAlgorithm::SHA256);
+
+    /* Hash @p data on a worker and call @p done there with the digest, or
+     * with a non-null error. The bytes must stay valid until @p done runs. */
+    void submit(std::span<const uint8_t> data, HashAlgorithm algorithm, Callback done);
+
+    /* Hash @p data on the calling thread */
+    Digest hash(std::span<const uint8_t> data, HashAlgorithm algorithm = HashAlgorithm::SHA256) const;
+
+    /* Serve one accepted client connection on a worker. The service owns
+     * @p client_fd from now on and closes it when the session ends. */
+    void serve(int client_fd);
+
+private:
+    /* Drives the timer wheel until destroyed */
+    struct Ticker {
+        explicit Ticker(TimerWheel& wheel);
+        ~Ticker();
+
+        std::atomic<bool> stop{false};
+        std::thread thread;
+    };
+
+    void handle_client(int client_fd);
+
+    service_options options;
+    TimerWheel timers;
+    SessionStore sessions;
+    Ticker ticker;
+    WorkerPool pool; // last, so it drains before the members above go away
+};
+
+#endif // HASH_SERVICE_H
@@ -0,0 +1,87 @@
+#ifndef HASHER_H
+#define HASHER_H
+
+#include "hash.h"
+
+#include <cstdint>
+#include <array>
+#include <string>
+#include <stdexcept>
+
+/**
+ * @brief RAII wrapper around a salted checksum context.
+ *
+ * The salt is applied by the checksum API in hash.cpp, so every algorithm
+ * shares the same salt handling. The algorithm is chosen once, when the
+ * context is created; after that OpenSSL's EVP layer dispatches to the
+ * digest implementation. A Hasher can be reused for several digests:
+ * finish() resets it for the next payload.
+ *
+ * @throws std::runtime_error if the context cannot be created or a
+ *         checksum call fails.
+ */
+class Hasher {
+public:
+    Hasher(const std::string& salt, HashAlgorithm algorithm) {
+        const uint8_t* salt_ptr = salt.empty() ? nullptr
+                                               : reinterpret_cast<const uint8_t*>(salt.data());
+        ctx = checksum_create_alg(salt_ptr, salt.size(), algorithm);
+        if (!ctx)
+            throw std::runtime_error("Failed to create checksum context");
+    }
+
+    ~Hasher() { checksum_destroy(ctx); }
+
+    Hasher(const Hasher&) = delete;
+    Hasher& operator=(const Hasher&) = delete;
+
+    void update(const uint8_t* data, size_t len) {
+        if (checksum_append(ctx, data, len) != 0)
+            throw std::runtime_error("checksum_append failed");
+    }
+
+    std::array<uint8_t, 32> finish() {
+        std::array<uint8_t, 32> digest{};
+        if (checksum_finish(ctx, nullptr, 0, digest.data()) != 0)
+            throw std::runtime_error("checksum_finish failed");
+        if (checksum_reset(ctx) != 0)
+            throw std::runtime_error("checksum_reset failed");
+        return digest;
+    }
+
+private:
+    checksum_ctx* ctx;
+};
+
+/* Verifies whether a value received on the wire names a known algorithm */
+inline bool isValidAlgorithm(uint32_t value) {
+    return value <= static_cast<uint32_t>(HashAlgorithm::BLAKE2s256);
+}
+
+/* Returns the command-line name of the algorithm (e.g. "sha256") */
+inline const char* algorithmName(HashAlgorithm algorithm) {
+    switch (algorithm) {
+    case HashAlgorithm::SHA256:
+        return "sha256";
+    case HashAlgorithm::SHA512_256:
+        return "sha512-256";
+    case HashAlgorithm::BLAKE2s256:
+        return "blake2s256";
+    }
+    return "unknown";
+}
+
+/* Parses a command-line algorithm name. On sucess returns True and
+ * stores the algorithm in @p out, on fail returns False.
+ */
+inline bool parseAlgorithm(const std::string& name, HashAlgorithm& out) {
+    for (HashAlgorithm alg : { HashAlgorithm::SHA256, HashAlgorithm::SHA512_256, HashAlgorithm::BLAKE2s256 }) {
+        if (name == algorithmName(alg)) {
+            out = alg;
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif // HASHER_H
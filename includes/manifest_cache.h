@@ -0,0 +1,64 @@
+#ifndef MANIFEST_CACHE_H
+#define MANIFEST_CACHE_H
+
+#include "hash.h"
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+/**
+ * @brief Local cache of server digests, keyed by chunk content.
+ *
+ * The server salts its digests with a secret the client does not know,
+ * so the client cannot compute them itself. Instead every chunk is
+ * identified by a local, unsalted SHA-256 fingerprint; if a fingerprint
+ * was sent before with the same algorithm, the cached server digest is
+ * reused and the chunk does not have to be sent again.
+ *
+ * The cache is a text file with a "server <address> <probe>" line and
+ * one "<algorithm> <fingerprint> <digest>" line per chunk (hex encoded).
+ * Cached digests are only valid for the server and salt that produced
+ * them, so the client hashes a fixed probe chunk on the server each run
+ * and bind()s the cache to the result. All methods are thread-safe.
+ */
+class ManifestCache {
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    /* Load entries from @p path. A missing file is an empty cache.
+     * Throws std::runtime_error on malformed files. */
+    void load(const std::string& path);
+
+    /* Write all entries to @p path, replacing it atomically.
+     * Throws std::runtime_error if the file cannot be written. */
+    void save(const std::string& path) const;
+
+    /* Tie the cache to the server at @p server, whose SHA-256 digest of
+     * the probe chunk is @p probe. If the loaded entries belong to another
+     * server or probe digest (e.g. the salt changed) they are dropped and
+     * True is returned. */
+    bool bind(const std::string& server, const Digest& probe);
+
+    /* On hit returns True and stores the server digest in @p digest */
+    bool lookup(HashAlgorithm algorithm, const Digest& fingerprint, Digest& digest) const;
+
+    void insert(HashAlgorithm algorithm, const Digest& fingerprint, const Digest& digest);
+
+private:
+    mutable std::mutex mtx;
+    std::string server;
+    Digest probe{};
+    std::map<std::pair<uint32_t, Digest>, Digest> entries;
+};
+
+/* Formats a digest as lowercase hex without a prefix */
+std::string toHex(const std::array<uint8_t, 32>& digest);
+
+/* Parses 64 hex characters into @p out. On sucess returns True */
+bool fromHex(const std::string& hex, std::array<uint8_t, 32>& out);
+
+#endif // MANIFEST_CACHE_H
@@ -6,6 +6,8 @@
 #include <stdio.h>
 #include <argp.h>
 
+#include "hash.h"
+
 // Struct to hold parsed arguments
 struct client_arguments {
     struct sockaddr_in addr;
@@ -14,6 +16,12 @@ struct client_arguments {
     int smax;
     std::string filename;
     FILE *file;
+    HashAlgorithm algorithm = HashAlgorithm::SHA256;
+    std::string path;
+    std::string manifest;
+    int jobs = 4;
+    bool resume = false;
+    int retries = 5;
 };
 
 /* Verifies whether provided string can be parsed as a number
@@ -28,6 +36,15 @@ bool isNumber(const std::string& s);
  *   --smin         : required minimum payload size (>= 1)
  *   --smax         : required maximum payload size (<= 2^24, >= smin)
  *   -f / --file    : required input file (must exist and be readable)
+ *   --algo         : optional digest algorithm (sha256, sha512-256,
+ *                    blake2s256), sha256 by default
+ *   --path         : file or directory to fingerprint with content-defined
+ *                    chunks instead of -n/-f; --smin/--smax then bound the
+ *                    chunk size (2048/65536 by default)
+ *   -j / --jobs    : number of files hashed in parallel in --path mode (>= 1)
+ *   --manifest     : manifest cache file used in --path mode
+ *   --resume       : ask for a resumable batch and reconnect on failures
+ *   --retries      : reconnect attempts per request with --resume (>= 0)
  *
  * Called by argp for each option. Performs validation and fills
  * a client_arguments struct. On invalid or missing options, reports
@@ -36,7 +53,8 @@ bool isNumber(const std::string& s);
 error_t client_parser(int key, char *arg, struct argp_state *state);
 
 /* Parse all client command-line arguments using argp.
- * Defines supported options (addr, port, hashreq, smin, smax, file),
+ * Defines supported options (addr, port, hashreq, smin, smax, file, algo,
+ * path, jobs, manifest, resume, retries),
  * delegates validation to client_parser, and fills a client_arguments struct.
  * On parse failure, prints an error; on success, prints the parsed values.
  */
@@ -9,6 +9,12 @@ struct server_arguments {
     int port;
     std::string salt;
     size_t salt_len;
+    int header_timeout = 30000;
+    int min_rate = 1024;
+    int batch_timeout = 0;
+    std::string trace_file;
+    double trace_rate = 1.0;
+    int resume_ttl = 60;
 };
 
 /* Verifies whether provided string can be parsed as a number
@@ -21,6 +27,10 @@ bool isNumber(const std::string& s);
  *   - 'p': sets the server port after validating that the argument is numeric
  *          and within the range [1025, 65535]. If invalid, an error is reported.
  *   - 's': sets the salt value and its length based on the provided argument.
+ *   - 300/301/302: set the header timeout (ms), payload throughput floor
+ *          (bytes/s) and batch timeout (s) after validating they are numeric.
+ *   - 303/304: set the trace output file and the trace sampling rate (0, 1].
+ *   - 305: sets how long (s) an interrupted resumable batch is retained.
  *   - ARGP_KEY_END: verifies that a port has been specified; otherwise reports an error.
  *
  * On success, returns 0. If the key is not recognized, returns ARGP_ERR_UNKNOWN.
@@ -32,6 +42,12 @@ error_t server_parser(int key, char *arg, struct argp_state *state);
 /* Parse server command-line options. Supports:
  *   -p / --port : required port number (validated range 1025–65535)
  *   -s / --salt : optional salt string
+ *   --header-timeout : optional per-message deadline in ms (30000, 0 = off)
+ *   --min-rate       : optional payload throughput floor in bytes/s (1024, 0 = off)
+ *   --batch-timeout  : optional deadline for a whole session in s (0 = off)
+ *   --trace          : optional Chrome trace JSON file, written on SIGUSR1
+ *   --trace-rate     : optional fraction of requests to trace (1 by default)
+ *   --resume-ttl     : optional retention of interrupted batches in s (60, 0 = off)
  * Uses argp with server_parser for validation. On success, prints the
  * parsed values; on error, reports via argp_error or prints a message.
  */
@@ -5,17 +5,45 @@
 #include <vector>
 #include <array>
 #include <string>
+#include <netinet/in.h>
+
+#include "hash.h"
 
 struct checksum_ctx;
+class SessionWatchdog;
 
 /* Protocol Message Types */
 enum class MessageType : uint32_t {
     InitRequest  = 1,
     AckResponse  = 2,
     HashRequest  = 3,
-    HashResponse = 4
+    HashResponse = 4,
+    ResumeRequest   = 5,
+    SessionResponse = 6
 };
 
+/* InitRequest::Type carries the MessageType in its low 16 bits and the
+ * requested HashAlgorithm in bits 16-23. Clients that predate algorithm
+ * negotiation send zeros there, which selects SHA-256. Bit 24 asks for a
+ * resumable batch: the server then follows its AckResponse with a
+ * SessionResponse carrying the token for a later ResumeRequest.
+ */
+constexpr uint32_t INIT_TYPE_MASK = 0xffff;
+constexpr uint32_t INIT_ALGORITHM_SHIFT = 16;
+constexpr uint32_t INIT_ALGORITHM_MASK = 0xff;
+constexpr uint32_t INIT_RESUMABLE = 1u << 24;
+
+/* Largest payload a HashRequest may announce */
+constexpr uint32_t MAX_PAYLOAD_SIZE = 1u << 24;
+
+/* AckResponse::Type echoes the algorithm the server will hash the batch
+ * with, using the same bits 16-23 as InitRequest::Type. Clients compare it
+ * with what they asked for: a server that predates negotiation leaves the
+ * bits zero and would silently answer with SHA-256. Likewise bit 24 is set
+ * only when a SessionResponse follows the AckResponse, so a client never
+ * waits for one from a server without resume support.
+ */
+
 /**
  * @brief Send a buffer over a socket.
  *
@@ -55,34 +83,76 @@ void receiveAny(int sockfd, void* buffer, ssize_t size, const char* errMsg);
  * it is included in the checksum computation. When all data is received,
  * the final 32-byte digest is returned.
  *
- * @param sockfd   Socket file descriptor.
- * @param size     Number of bytes to receive.
- * @param salt     Optional string used as checksum salt (may be empty).
- * @param errMsg   Error message included in the exception if receiving fails.
+ * @param sockfd    Socket file descriptor.
+ * @param size      Number of bytes to receive.
+ * @param salt      Optional string used as checksum salt (may be empty).
+ * @param errMsg    Error message included in the exception if receiving fails.
+ * @param algorithm Digest algorithm, SHA-256 by default.
+ * @param watchdog  Optional watchdog; the payload deadline is re-armed for
+ *                  every PAYLOAD_DEADLINE_SLICE bytes as they arrive.
  *
  * @return std::array<uint8_t, 32>  Final computed hash digest.
  *
  * @throws std::runtime_error on socket errors or checksum API errors.
  */
-std::array<uint8_t, 32> receiveHash(int sockfd, ssize_t size, const std::string& salt, const char* errMsg);
+std::array<uint8_t, 32> receiveHash(int sockfd, ssize_t size, const std::string& salt, const char* errMsg,
+                                    HashAlgorithm algorithm = HashAlgorithm::SHA256,
+                                    SessionWatchdog* watchdog = nullptr);
+
+/**
+ * @brief Open a TCP connection to @p addr.
+ *
+ * @return The connected socket file descriptor.
+ *
+ * @throws std::runtime_error if the socket cannot be created or connected.
+ */
+int connectTo(const struct sockaddr_in& addr);
+
+/**
+ * @brief Receive the type field that starts every client message.
+ *
+ * Lets a server accept either an InitRequest or a ResumeRequest as the
+ * first message; the rest is read with the matching receiveFields().
+ *
+ * @return The type field in host byte order.
+ *
+ * @throws std::runtime_error if the socket is closed or an error occurs.
+ */
+uint32_t receiveType(int sockfd);
 
 /* Protocol Structures */
 struct InitRequest {
     uint32_t Type;
     uint32_t N;
 
-    void setValues(int n);
+    void setValues(int n, HashAlgorithm algorithm = HashAlgorithm::SHA256, bool resumable = false);
     void sendTo(int sockfd) const;
     void receive(int sockfd);
+    void receiveFields(int sockfd);
+
+    /* Whether the client asked for a resumable batch */
+    bool resumable() const;
+
+    /* Algorithm requested by the client. Throws std::runtime_error if
+     * the client asked for an algorithm this build does not know. */
+    HashAlgorithm algorithm() const;
 };
 
 struct AckResponse {
     uint32_t Type;
     uint32_t Length;
 
-    void setValues(MessageType type, int length);
+    void setValues(MessageType type, int length, HashAlgorithm algorithm = HashAlgorithm::SHA256,
+                   bool resumable = false);
     void sendTo(int sockfd) const;
     void receive(int sockfd);
+
+    /* Whether a SessionResponse follows */
+    bool resumable() const;
+
+    /* Algorithm the server chose for the batch. Throws std::runtime_error
+     * if the server named an algorithm this build does not know. */
+    HashAlgorithm algorithm() const;
 };
 
 struct HashRequest {
@@ -92,7 +162,23 @@ struct HashRequest {
 
     void setValues(int length, FILE* file);
     void sendTo(int sockfd) const;
-    std::array<uint8_t, 32> receive(int sockfd, const std::string& salt);
+
+    /* Send a request whose payload lives in the caller's buffer (e.g. a
+     * mapped file): setHeader() fills in Type and Length only, and
+     * sendTo() sends the header followed by Length bytes of @p payload
+     * without copying them into Payload. */
+    void setHeader(int length);
+    void sendTo(int sockfd, const uint8_t* payload) const;
+    std::array<uint8_t, 32> receive(int sockfd, const std::string& salt,
+                                    HashAlgorithm algorithm = HashAlgorithm::SHA256);
+
+    /* The two halves of receive(), for callers that need to act once the
+     * payload length is known. receiveHeader() throws std::runtime_error
+     * if the length exceeds MAX_PAYLOAD_SIZE. */
+    void receiveHeader(int sockfd);
+    std::array<uint8_t, 32> receivePayload(int sockfd, const std::string& salt,
+                                           HashAlgorithm algorithm = HashAlgorithm::SHA256,
+                                           SessionWatchdog* watchdog = nullptr);
 };
 
 struct HashResponse {
@@ -105,4 +191,30 @@ struct HashResponse {
     void receive(int sockfd);
 };
 
+/* Sent by a reconnecting client instead of InitRequest. Received is the
+ * number of HashResponses the client already holds (indices 0..Received-1). */
+struct ResumeRequest {
+    uint32_t Type;
+    uint64_t Token;
+    uint32_t Received;
+
+    void setValues(uint64_t token, int received);
+    void sendTo(int sockfd) const;
+    void receiveFields(int sockfd);
+};
+
+/* Follows the AckResponse of a resumable batch. Token identifies the
+ * batch (0 if the server refused to start or resume it) and Next is the
+ * index of the next HashRequest the server expects. On resume, the server
+ * then replays the HashResponses from Received up to Next. */
+struct SessionResponse {
+    uint32_t Type;
+    uint64_t Token;
+    uint32_t Next;
+
+    void setValues(uint64_t token, int next);
+    void sendTo(int sockfd) const;
+    void receive(int sockfd);
+};
+
 #endif // REQUESTS_H
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "hash.h"
+#include "timer_wheel.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/* Progress of one resumable batch. While a connection is attached to the
+ * session only that connection's thread touches the fields below token. */
+struct resumable_session {
+    uint64_t token;
+    uint32_t n;
+    HashAlgorithm algorithm;
+    uint32_t next = 0;                           // index of the next HashRequest expected
+    uint32_t base = 0;                           // index of digests.front()
+    std::deque<std::array<uint8_t, 32>> digests; // retained digests [base, next)
+
+    /* Store the digest for request `next` and advance. Only the newest
+     * `window` digests are retained. */
+    void record(const std::array<uint8_t, 32>& digest, size_t window);
+
+private:
+    friend class SessionStore;
+    int sockfd = -1;         // attached connection, -1 while parked
+    uint64_t generation = 0; // bumped on every detach, guards stale expiry timers
+    uint64_t parked_at = 0;  // key in SessionStore::parked while parked
+    bool taken_over = false; // a resume shut the attached connection down
+};
+
+/**
+ * @brief Server-side table of resumable batches.
+ *
+ * A batch is attached to at most one connection. When the connection
+ * drops before the batch completes, the session is parked: its retained
+ * digests stay available for @p ttl so a client can reconnect with a
+ * ResumeRequest, after which the session is dropped. Expiry is tracked
+ * in the shared TimerWheel. At most @p max_parked sessions are parked at
+ * once; parking another one drops the oldest, so abandoned batches cannot
+ * pile up retained digests. All methods are thread-safe.
+ */
+class SessionStore {
+public:
+    SessionStore(TimerWheel& wheel, std::chrono::seconds ttl, size_t window, size_t max_parked);
+
+    /* Whether sessions are retained at all (ttl > 0 and max_parked > 0) */
+    bool enabled() const { return ttl.count() > 0 && max_parked > 0; }
+
+    /* Number of digests retained per session */
+    size_t retained() const { return window; }
+
+    /* Start a new session attached to @p sockfd, with a fresh random token */
+    std::shared_ptr<resumable_session> create(int sockfd, uint32_t n, HashAlgorithm algorithm);
+
+    /* Attach @p sockfd to a parked session, dropping retained digests
+     * below @p received. Returns nullptr if the token is unknown or
+     * expired, or if @p received is outside the retained range. If the
+     * session is still attached to an older connection, that connection
+     * is shut down (so it detaches soon) and nullptr is returned; the
+     * client should retry. */
+    std::shared_ptr<resumable_session> attach(uint64_t token, int sockfd, uint32_t received);
+
+    /* Detach the session from its connection. If the client is known to
+     * hold every response (@p delivered) the session is dropped, otherwise
+     * it is parked for the ttl. A session whose connection was shut down by
+     * attach() is always parked: the EOF its thread saw came from us, not
+     * from the client. Must be called before the connection's socket is
+     * closed. */
+    void release(const std::shared_ptr<resumable_session>& session, bool delivered);
+
+private:
+    void expire(uint64_t token, uint64_t generation);
+
+    TimerWheel& wheel;
+    std::chrono::seconds ttl;
+    size_t window;
+    size_t max_parked;
+    std::mutex mtx;
+    std::unordered_map<uint64_t, std::shared_ptr<resumable_session>> sessions;
+    std::map<uint64_t, uint64_t> parked; // parked_at -> token, oldest first
+    uint64_t parks = 0;                  // source of parked_at
+};
+
+#endif // SESSION_H
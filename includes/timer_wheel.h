@@ -0,0 +1,78 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * @brief Hierarchical timer wheel.
+ *
+ * Timers are kept in LEVELS wheels of SLOTS buckets each. Level 0 has a
+ * resolution of one tick; every higher level covers SLOTS times the span
+ * of the level below it, and its buckets are cascaded down as time
+ * reaches them. Scheduling and cancelling are O(1), and advancing costs
+ * O(1) per tick plus the timers that are cascaded or fired, so the wheel
+ * scales to very large numbers of pending timers.
+ *
+ * Delays longer than the wheel span (SLOTS^LEVELS ticks) are clamped to
+ * it. All methods are thread-safe; callbacks run on the thread calling
+ * advance(), after the internal lock has been released.
+ */
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    using TimerId = uint64_t;
+
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr unsigned SLOTS = 1u << SLOT_BITS;
+    static constexpr unsigned LEVELS = 4;
+
+    explicit TimerWheel(Clock::duration tick = std::chrono::milliseconds(10));
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /* Run @p cb once, no earlier than @p delay from now (rounded up to
+     * the next tick). Returns an id usable with cancel(); never 0. */
+    TimerId schedule(Clock::duration delay, Callback cb);
+
+    /* Remove a pending timer. Returns false if it already fired (or is
+     * firing right now) or the id is unknown. */
+    bool cancel(TimerId id);
+
+    /* Process every tick up to @p now and run the expired callbacks.
+     * Returns the number of callbacks run. */
+    size_t advance(Clock::time_point now);
+
+    /* Tick length the wheel was created with */
+    Clock::duration resolution() const { return tick; }
+
+private:
+    struct Timer {
+        TimerId id;
+        uint64_t expires;
+        Callback cb;
+        Timer* prev = nullptr;
+        Timer* next = nullptr;
+        Timer** bucket = nullptr;
+    };
+
+    void link(Timer* timer);
+    static void unlink(Timer* timer);
+
+    std::mutex mtx;
+    std::array<std::array<Timer*, SLOTS>, LEVELS> wheel{};
+    std::unordered_map<TimerId, Timer*> timers;
+    Clock::time_point start;
+    Clock::duration tick;
+    uint64_t current = 0;
+    TimerId nextId = 1;
+};
+
+#endif // TIMER_WHEEL_H
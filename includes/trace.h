@@ -0,0 +1,68 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <string>
+
+/* Opt-in per-request tracing.
+ *
+ * Every traced request records five timestamps into a lock-free ring
+ * buffer owned by the recording thread. Rings are only read by
+ * trace_dump(), which writes them out as Chrome trace JSON (loadable in
+ * chrome://tracing or Perfetto). Old spans are overwritten once a ring
+ * is full.
+ *
+ * The payload is hashed while it arrives, so RecvComplete..HashComplete
+ * only covers finishing the digest. The time spent hashing received
+ * chunks is summed separately (trace_update_begin/end) and reported
+ * with the recv slice.
+ *
+ * Call sites go through the TRACE() macro, so with tracing disabled the
+ * cost is a single well-predicted branch on trace_enabled.
+ */
+
+/* Set by trace_configure() before any session starts, read-only after */
+extern bool trace_enabled;
+
+enum class TracePoint : unsigned {
+    WaitStart    = 0, // server ready for the next request
+    RecvStart    = 1, // request header received
+    RecvComplete = 2, // last payload byte received and hashed
+    HashComplete = 3, // digest finished
+    SendComplete = 4  // response sent
+};
+
+#define TRACE(call)                                   \
+    do {                                              \
+        if (__builtin_expect(trace_enabled, 0))       \
+            call;                                     \
+    } while (0)
+
+/* Enable tracing and sample each request with probability @p rate
+ * (0 < rate <= 1). A rate of 0 leaves tracing disabled. */
+void trace_configure(double rate);
+
+/* Start a span for request @p index on the calling thread and record
+ * TracePoint::WaitStart, if the sampler picks this request. */
+void trace_begin(uint32_t index);
+
+/* Record @p point for the calling thread's current span, if any */
+void trace_mark(TracePoint point);
+
+/* Whether the calling thread has a sampled span in progress */
+bool trace_sampled();
+
+/* Bracket one update of the running digest; the time in between is
+ * added to the current span's hashing time. Only valid while
+ * trace_sampled() holds, so callers can check once per payload. */
+void trace_update_begin();
+void trace_update_end();
+
+/* Record TracePoint::SendComplete and publish the current span */
+void trace_end();
+
+/* Write every published span to @p path as Chrome trace JSON. Safe to
+ * call while other threads are recording. Returns true on success. */
+bool trace_dump(const std::string& path);
+
+#endif // TRACE_H
@@ -0,0 +1,98 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include "timer_wheel.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+/* Deadlines enforced on every client session. A zero value disables
+ * the corresponding deadline.
+ *   header   : time allowed for each fixed-size message (request headers,
+ *              InitRequest, and every response we send)
+ *   min_rate : throughput floor in bytes/s for payloads; every slice of
+ *              L <= PAYLOAD_DEADLINE_SLICE bytes gets header + L / min_rate
+ *              to arrive; with a zero floor payloads have no deadline
+ *   batch    : time allowed for the whole session
+ */
+struct deadline_settings {
+    std::chrono::milliseconds header{0};
+    uint32_t min_rate = 0;
+    std::chrono::milliseconds batch{0};
+};
+
+/* Payloads are given a fresh deadline for every slice of this many bytes,
+ * so the floor holds throughout a payload instead of on average */
+constexpr size_t PAYLOAD_DEADLINE_SLICE = 64 * 1024;
+
+/* Which deadline caused a session to be evicted */
+enum class Eviction : unsigned {
+    None    = 0,
+    Header  = 1,
+    Payload = 2,
+    Send    = 3,
+    Batch   = 4
+};
+
+/* Returns a human readable name for the eviction reason */
+const char* evictionName(Eviction reason);
+
+/* Returns the number of sessions evicted for @p reason since startup */
+uint64_t evictionCount(Eviction reason);
+
+/**
+ * @brief Enforces read/write deadlines for one client socket.
+ *
+ * Each expect*() call replaces the current I/O deadline with a new one
+ * tracked in the shared TimerWheel; startBatch() arms an additional
+ * deadline for the whole session. When a deadline expires the socket is
+ * shut down, which makes the blocked recv/send in the session thread
+ * fail, and the eviction is counted.
+ *
+ * The watchdog must be destroyed before the socket is closed, so a
+ * late timer can never shut down a reused descriptor.
+ */
+class SessionWatchdog {
+public:
+    SessionWatchdog(TimerWheel& wheel, int sockfd, const deadline_settings& settings);
+    ~SessionWatchdog();
+
+    SessionWatchdog(const SessionWatchdog&) = delete;
+    SessionWatchdog& operator=(const SessionWatchdog&) = delete;
+
+    /* Arm the deadline for receiving a fixed-size message */
+    void expectHeader();
+
+    /* Arm the deadline for receiving the next @p length payload bytes */
+    void expectPayload(size_t length);
+
+    /* Arm the deadline for sending a response */
+    void expectSend();
+
+    /* Arm the deadline for the whole session */
+    void startBatch();
+
+    /* Returns the reason the session was evicted, or Eviction::None */
+    Eviction reason() const;
+
+private:
+    struct State {
+        std::mutex mtx;
+        int sockfd;
+        std::atomic<Eviction> reason{Eviction::None};
+    };
+
+    void arm(TimerWheel::TimerId& timer, std::chrono::milliseconds delay, Eviction reason);
+    void disarm(TimerWheel::TimerId& timer);
+
+    TimerWheel& wheel;
+    deadline_settings settings;
+    std::shared_ptr<State> state;
+    TimerWheel::TimerId ioTimer = 0;
+    TimerWheel::TimerId batchTimer = 0;
+};
+
+#endif // WATCHDOG_H
@@ -0,0 +1,50 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+/**
+ * @brief Elastic pool of worker threads.
+ *
+ * Every posted job starts without waiting behind other jobs: if no worker
+ * is idle a new thread is started. This matters because the pool runs both
+ * short jobs (single digests) and jobs that block for a whole client
+ * connection. Idle workers above @p keep exit after @p idle_timeout, so
+ * the pool shrinks back once a burst is over.
+ *
+ * Exceptions escaping a job are reported on stderr. The destructor stops
+ * accepting jobs, lets the queued and running ones finish, and waits for
+ * every worker to exit.
+ */
+class WorkerPool {
+public:
+    explicit WorkerPool(size_t keep, std::chrono::seconds idle_timeout = std::chrono::seconds(30));
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /* Run @p job on a worker thread. Throws std::runtime_error after the
+     * pool started shutting down. */
+    void post(std::function<void()> job);
+
+private:
+    void work();
+
+    size_t keep;
+    std::chrono::seconds idle_timeout;
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::condition_variable exited;
+    std::deque<std::function<void()>> jobs;
+    size_t threads = 0;
+    size_t idle = 0;
+    bool stopping = false;
+};
+
+#endif // WORKER_POOL_H
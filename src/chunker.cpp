@@ -0,0 +1,79 @@
+#include "chunker.h"
+
+#include <array>
+#include <bit>
+#include <stdexcept>
+
+using namespace std;
+
+/* 256 pseudo-random 64-bit values, generated with splitmix64 from a fixed
+ * seed. Changing the seed changes every cut point. */
+static constexpr array<uint64_t, 256> make_gear() {
+    array<uint64_t, 256> gear{};
+    uint64_t state = 0x6a09e667f3bcc908ULL;
+    for (uint64_t& value : gear) {
+        state += 0x9e3779b97f4a7c15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        value = z ^ (z >> 31);
+    }
+    return gear;
+}
+
+static constexpr array<uint64_t, 256> GEAR = make_gear();
+
+/* A mask with @p bits bits set at the top of the word. The gear hash is
+ * shifted left once per byte, so its top bits depend on the last 64
+ * bytes rather than only the most recent few. */
+static uint64_t top_mask(unsigned bits) {
+    if (bits == 0)
+        return 0;
+    if (bits >= 64)
+        return ~uint64_t(0);
+    return ~uint64_t(0) << (64 - bits);
+}
+
+Chunker::Chunker(size_t min_size, size_t avg_size, size_t max_size)
+    : min_size(min_size), avg_size(bit_floor(avg_size)), max_size(max_size) {
+    if (min_size == 0 || avg_size == 0 || min_size > max_size)
+        throw invalid_argument("Chunker needs 0 < min_size <= max_size and avg_size > 0");
+
+    // Harder to cut before the average size, easier after it
+    unsigned bits = countr_zero(this->avg_size);
+    mask_small = top_mask(bits + 2);
+    mask_large = top_mask(bits >= 2 ? bits - 2 : 0);
+}
+
+size_t Chunker::next(const uint8_t* data, size_t len) const {
+    if (len <= min_size)
+        return len;
+    if (len > max_size)
+        len = max_size;
+    size_t normal = avg_size < len ? avg_size : len;
+
+    uint64_t hash = 0;
+    size_t i = min_size;
+    for (; i < normal; ++i) {
+        hash = (hash << 1) + GEAR[data[i]];
+        if (!(hash & mask_small))
+            return i + 1;
+    }
+    for (; i < len; ++i) {
+        hash = (hash << 1) + GEAR[data[i]];
+        if (!(hash & mask_large))
+            return i + 1;
+    }
+    return len;
+}
+
+vector<chunk> Chunker::split(const uint8_t* data, size_t len) const {
+    vector<chunk> chunks;
+    size_t offset = 0;
+    while (offset < len) {
+        size_t length = next(data + offset, len - offset);
+        chunks.push_back({offset, length});
+        offset += length;
+    }
+    return chunks;
+}
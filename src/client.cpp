@@ -1,11 +1,16 @@
 #include "parser_client.h"
 #include "requests.h"
+#include "file_client.h"
+#include "hasher.h"
 
 #include <iostream>
 #include <random>
 #include <iomanip>
 #include <unistd.h>
 #include <cstring>
+#include <chrono>
+#include <thread>
+#include <endian.h>
 
 using namespace std;
 
@@ -18,10 +23,41 @@ ostream& operator<<(ostream& os, HashResponse const& resp) {
     return os;
 }
 
+/* Reconnect and ask the server to continue the batch identified by
+ * token, given that responses 0..received-1 have been printed. Returns
+ * the new socket and stores the index of the next request the server
+ * expects in next. Throws if the connection fails or the server refuses.
+ */
+int resumeBatch(const struct sockaddr_in& addr, uint64_t token, int received, int& next) {
+    int sockfd = connectTo(addr);
+    try {
+        ResumeRequest resume;
+        resume.setValues(token, received);
+        resume.sendTo(sockfd);
+
+        AckResponse ack;
+        ack.receive(sockfd);
+        if (!ack.resumable())
+            throw runtime_error("Server does not support resuming batches");
+
+        SessionResponse session;
+        session.receive(sockfd);
+        if (session.Token == 0)
+            throw runtime_error("Server refused to resume the batch");
+        next = ntohl(session.Next);
+    } catch (...) {
+        close(sockfd);
+        throw;
+    }
+    return sockfd;
+}
+
 int main(int argc, char *argv[]) {
     try {
         client_arguments args{};
         client_parseopt(args, argc, argv);
+        if (args.path != "")
+            return hash_path(args);
 
         int sockfd = socket(AF_INET, SOCK_STREAM, 0);
         if (sockfd < 0) {
@@ -36,22 +72,63 @@ int main(int argc, char *argv[]) {
         }
 
         InitRequest initreq;
-        initreq.setValues(args.hashnum);
+        initreq.setValues(args.hashnum, args.algorithm, args.resume);
         initreq.sendTo(sockfd);
 
         AckResponse ack;
         ack.receive(sockfd);
+        if (ack.algorithm() != args.algorithm)
+            throw runtime_error(string("Server hashes with ") + algorithmName(ack.algorithm())
+                                + " instead of " + algorithmName(args.algorithm));
+
+        uint64_t token = 0;
+        if (args.resume && !ack.resumable()) {
+            cerr << "Server does not support resuming, continuing without it\n";
+        } else if (args.resume) {
+            SessionResponse session;
+            session.receive(sockfd);
+            token = be64toh(session.Token);
+            if (token == 0)
+                cerr << "Server does not retain this batch, it cannot be resumed\n";
+        }
 
         for (int i = 0; i < args.hashnum; ++i) {
             HashRequest hashreq;
             int L = args.smin + rand() % (args.smax - args.smin + 1);
             hashreq.setValues(L, args.file);
-            hashreq.sendTo(sockfd);
 
             HashResponse resp{};
-            resp.receive(sockfd);
+            bool connected = true;
+            bool sent = false;
+            for (int attempts = 0; ; ) {
+                try {
+                    if (!connected) {
+                        int next;
+                        sockfd = resumeBatch(args.addr, token, i, next);
+                        connected = true;
+                        sent = next > i;
+                    }
+                    if (!sent) {
+                        hashreq.sendTo(sockfd);
+                        sent = true;
+                    }
+                    resp.receive(sockfd);
+                    break;
+                } catch (const exception &ex) {
+                    if (token == 0 || ++attempts > args.retries)
+                        throw;
+                    cerr << "Request " << i << " failed (" << ex.what() << "), resuming, attempt "
+                         << attempts << " of " << args.retries << "\n";
+                    if (connected) {
+                        close(sockfd);
+                        connected = false;
+                    }
+                    this_thread::sleep_for(chrono::seconds(attempts));
+                }
+            }
             cout << i << ": " << resp << "\n";
         }
+        close(sockfd);
     } catch (const exception &ex) {
         cerr << "Error: " << ex.what() << "\n";
         return 1;
@@ -0,0 +1,247 @@
+#include "file_client.h"
+#include "chunker.h"
+#include "hasher.h"
+#include "manifest_cache.h"
+#include "requests.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/* Fixed chunk hashed on the server to tell whether cached digests still
+ * match its salt */
+static const char CACHE_PROBE[] = "TCP-file-hashes manifest cache probe";
+
+/* Read-only mapping of a whole file; empty files are not mapped */
+class MappedFile {
+public:
+    explicit MappedFile(const string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw runtime_error(string("open() failed: ") + strerror(errno));
+
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            int err = errno;
+            close(fd);
+            throw runtime_error(string("fstat() failed: ") + strerror(err));
+        }
+
+        length = st.st_size;
+        if (length > 0) {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                int err = errno;
+                close(fd);
+                throw runtime_error(string("mmap() failed: ") + strerror(err));
+            }
+            madvise(mapped, length, MADV_SEQUENTIAL);
+            bytes = static_cast<const uint8_t*>(mapped);
+        }
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (bytes)
+            munmap(const_cast<uint8_t*>(bytes), length);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+};
+
+/* Send the chunks listed in @p todo as one batch and store the returned
+ * digests at the same positions in @p digests. Requests are sent from a
+ * second thread so that neither side can stall on a full socket buffer
+ * while the other is still sending. */
+static void request_digests(const struct sockaddr_in& addr, HashAlgorithm algorithm, const uint8_t* data,
+                            const vector<chunk>& chunks, const vector<size_t>& todo,
+                            vector<array<uint8_t, 32>>& digests) {
+    int sockfd = connectTo(addr);
+    try {
+        InitRequest init;
+        init.setValues(todo.size(), algorithm);
+        init.sendTo(sockfd);
+
+        AckResponse ack;
+        ack.receive(sockfd);
+        if (ack.algorithm() != algorithm)
+            throw runtime_error(string("Server hashes with ") + algorithmName(ack.algorithm())
+                                + " instead of " + algorithmName(algorithm));
+
+        exception_ptr sendError;
+        thread sender([&] {
+            try {
+                for (size_t k : todo) {
+                    HashRequest req;
+                    req.setHeader(chunks[k].length);
+                    req.sendTo(sockfd, data + chunks[k].offset);
+                }
+            } catch (...) {
+                sendError = current_exception();
+                shutdown(sockfd, SHUT_RDWR);
+            }
+        });
+
+        try {
+            for (size_t k = 0; k < todo.size(); ++k) {
+                HashResponse resp{};
+                resp.receive(sockfd);
+                if (ntohl(resp.I) != k)
+                    throw runtime_error("Server answered out of order");
+                digests[todo[k]] = resp.Hash;
+            }
+        } catch (...) {
+            shutdown(sockfd, SHUT_RDWR);
+            sender.join();
+            throw;
+        }
+        sender.join();
+        if (sendError)
+            rethrow_exception(sendError);
+    } catch (...) {
+        close(sockfd);
+        throw;
+    }
+    close(sockfd);
+}
+
+/* SHA-256 digest of CACHE_PROBE as computed by the server */
+static array<uint8_t, 32> probe_server(const struct sockaddr_in& addr) {
+    vector<chunk> chunks{{0, sizeof(CACHE_PROBE) - 1}};
+    vector<array<uint8_t, 32>> digests(1);
+    request_digests(addr, HashAlgorithm::SHA256, reinterpret_cast<const uint8_t*>(CACHE_PROBE), chunks, {0},
+                    digests);
+    return digests[0];
+}
+
+/* Formats the server address as "<ip>:<port>" */
+static string server_address(const struct sockaddr_in& addr) {
+    char ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+    return string(ip) + ":" + to_string(ntohs(addr.sin_port));
+}
+
+/* Chunk and hash one file, returning its manifest text */
+static string hash_file(const client_arguments& args, const Chunker& chunker, ManifestCache* cache,
+                        const string& path) {
+    MappedFile file(path);
+    vector<chunk> chunks = chunker.split(file.data(), file.size());
+    vector<array<uint8_t, 32>> digests(chunks.size());
+    vector<array<uint8_t, 32>> fingerprints;
+    vector<size_t> todo;
+
+    if (cache) {
+        Hasher fingerprinter("", HashAlgorithm::SHA256);
+        fingerprints.resize(chunks.size());
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            fingerprinter.update(file.data() + chunks[i].offset, chunks[i].length);
+            fingerprints[i] = fingerprinter.finish();
+            if (!cache->lookup(args.algorithm, fingerprints[i], digests[i]))
+                todo.push_back(i);
+        }
+    } else {
+        for (size_t i = 0; i < chunks.size(); ++i)
+            todo.push_back(i);
+    }
+
+    if (!todo.empty())
+        request_digests(args.addr, args.algorithm, file.data(), chunks, todo, digests);
+
+    if (cache) {
+        for (size_t i : todo)
+            cache->insert(args.algorithm, fingerprints[i], digests[i]);
+    }
+
+    ostringstream manifest;
+    manifest << path << ": " << chunks.size() << " chunks, " << todo.size() << " sent\n";
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        manifest << "  " << i << ": " << chunks[i].offset << " " << chunks[i].length
+                 << " 0x" << toHex(digests[i]) << "\n";
+    }
+    return manifest.str();
+}
+
+int hash_path(const client_arguments& args) {
+    vector<string> files;
+    if (fs::is_directory(args.path)) {
+        for (const auto& entry : fs::recursive_directory_iterator(args.path, fs::directory_options::skip_permission_denied)) {
+            if (entry.is_regular_file())
+                files.push_back(entry.path().string());
+        }
+        sort(files.begin(), files.end());
+    } else {
+        files.push_back(args.path);
+    }
+
+    ManifestCache cache;
+    ManifestCache* cachePtr = nullptr;
+    if (args.manifest != "") {
+        cache.load(args.manifest);
+        if (cache.bind(server_address(args.addr), probe_server(args.addr)))
+            cerr << "Manifest cache " << args.manifest << " belongs to another server or salt, discarding it\n";
+        cachePtr = &cache;
+    }
+
+    // Aim the average chunk at the geometric mean of the size bounds
+    size_t avg = sqrt(double(args.smin) * double(args.smax));
+    Chunker chunker(args.smin, avg, args.smax);
+
+    atomic<size_t> next{0};
+    atomic<bool> failed{false};
+    mutex output;
+    auto worker = [&] {
+        for (size_t i; (i = next++) < files.size();) {
+            try {
+                string manifest = hash_file(args, chunker, cachePtr, files[i]);
+                lock_guard<mutex> lock(output);
+                cout << manifest;
+            } catch (const exception &ex) {
+                failed = true;
+                lock_guard<mutex> lock(output);
+                cerr << "Error: " << files[i] << ": " << ex.what() << "\n";
+            }
+        }
+    };
+
+    vector<thread> workers;
+    size_t jobs = min(size_t(args.jobs), files.size());
+    for (size_t j = 0; j < jobs; ++j)
+        workers.emplace_back(worker);
+    for (thread& t : workers)
+        t.join();
+
+    if (cachePtr) {
+        try {
+            cache.save(args.manifest);
+        } catch (const exception &ex) {
+            failed = true;
+            cerr << "Error: " << ex.what() << "\n";
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -15,14 +15,34 @@ struct checksum_ctx {
 };
 
 
+static const EVP_MD *checksum_md(HashAlgorithm alg) {
+	switch (alg) {
+	case HashAlgorithm::SHA256:
+		return EVP_sha256();
+	case HashAlgorithm::SHA512_256:
+		return EVP_sha512_256();
+	case HashAlgorithm::BLAKE2s256:
+		return EVP_blake2s256();
+	}
+	return NULL;
+}
+
 struct checksum_ctx * checksum_create(const uint8_t *salt, size_t len) {
-		struct checksum_ctx *csm = static_cast<checksum_ctx*>(malloc(sizeof(*csm)));
+	return checksum_create_alg(salt, len, HashAlgorithm::SHA256);
+}
+
+struct checksum_ctx * checksum_create_alg(const uint8_t *salt, size_t len, HashAlgorithm alg) {
+	const EVP_MD *md = checksum_md(alg);
+	if (!md) {
+		return NULL;
+	}
+	struct checksum_ctx *csm = static_cast<checksum_ctx*>(malloc(sizeof(*csm)));
 	if (!csm) {
 		goto err;
 	}
 	bzero(csm, sizeof(*csm));
 	csm->ctx = EVP_MD_CTX_new();
-	csm->md = EVP_sha256();
+	csm->md = md;
 	csm->len = len;
 	if (len > 0) {
 		csm->salt = static_cast<uint8_t*>(malloc(len));
@@ -55,6 +75,10 @@ int checksum_update(struct checksum_ctx *csm, const uint8_t *payload) {
 	return EVP_DigestUpdate(csm->ctx, payload, UPDATE_PAYLOAD_SIZE) != 1;
 }
 
+int checksum_append(struct checksum_ctx *csm, const uint8_t *payload, size_t len) {
+	return EVP_DigestUpdate(csm->ctx, payload, len) != 1;
+}
+
 int checksum_finish(struct checksum_ctx *csm, const uint8_t *payload, size_t len, uint8_t *out) {
 	int ret = 1;
 	if (len) {
@@ -0,0 +1,213 @@
+#include "hash_service.h"
+#include "hasher.h"
+#include "requests.h"
+#include "trace.h"
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <endian.h>
+#include <unistd.h>
+
+using namespace std;
+
+HashService::Ticker::Ticker(TimerWheel& wheel) {
+    thread = std::thread([this, &wheel] {
+        while (!stop.load()) {
+            this_thread::sleep_for(wheel.resolution());
+            wheel.advance(TimerWheel::Clock::now());
+        }
+    });
+}
+
+HashService::Ticker::~Ticker() {
+    stop.store(true);
+    thread.join();
+}
+
+static size_t default_workers(size_t workers) {
+    if (workers)
+        return workers;
+    size_t cores = std::thread::hardware_concurrency();
+    return cores ? cores : 1;
+}
+
+HashService::HashService(service_options options)
+    : options(std::move(options)),
+      sessions(timers, this->options.resume_ttl, this->options.resume_window, this->options.resume_parked),
+      ticker(timers),
+      pool(default_workers(this->options.workers)) {}
+
+HashService::Digest HashService::hash(span<const uint8_t> data, HashAlgorithm algorithm) const {
+    Hasher hasher(options.salt, algorithm);
+    hasher.update(data.data(), data.size());
+    return hasher.finish();
+}
+
+future<HashService::Digest> HashService::submit(span<const uint8_t> data, HashAlgorithm algorithm) {
+    auto result = make_shared<promise<Digest>>();
+    future<Digest> digest = result->get_future();
+    pool.post([this, data, algorithm, result] {
+        try {
+            result->set_value(hash(data, algorithm));
+        } catch (...) {
+            result->set_exception(current_exception());
+        }
+    });
+    return digest;
+}
+
+void HashService::submit(span<const uint8_t> data, HashAlgorithm algorithm, Callback done) {
+    pool.post([this, data, algorithm, done = std::move(done)] {
+        Digest digest{};
+        exception_ptr error;
+        try {
+            digest = hash(data, algorithm);
+        } catch (...) {
+            error = current_exception();
+        }
+        done(digest, error);
+    });
+}
+
+void HashService::serve(int client_fd) {
+    try {
+        pool.post([this, client_fd] { handle_client(client_fd); });
+    } catch (...) {
+        close(client_fd);
+        throw;
+    }
+}
+
+/* Progress of the batch served on one connection */
+struct batch_state {
+    uint32_t n = 0;
+    uint32_t next = 0;
+    HashAlgorithm algorithm = HashAlgorithm::SHA256;
+    shared_ptr<resumable_session> session;
+};
+
+/* Read the first message of a connection and answer it. An InitRequest
+ * starts a batch at index 0, resumable if the client asked for it. A
+ * ResumeRequest continues a parked session: the responses the client
+ * has not received yet are replayed and batch.next is set to the first
+ * request the server still needs. batch.session is set as soon as a
+ * session is attached, so the caller can release it on any error.
+ */
+static void start_batch(int client_fd, SessionStore& sessions, SessionWatchdog& watchdog, batch_state& batch) {
+    watchdog.expectHeader();
+    uint32_t type = receiveType(client_fd);
+
+    if ((type & INIT_TYPE_MASK) == static_cast<uint32_t>(MessageType::InitRequest)) {
+        InitRequest init;
+        init.Type = htonl(type);
+        init.receiveFields(client_fd);
+        batch.n = ntohl(init.N);
+        batch.algorithm = init.algorithm();
+
+        AckResponse ack{};
+        ack.setValues(MessageType::AckResponse, batch.n*40, batch.algorithm, init.resumable());
+        watchdog.expectSend();
+        ack.sendTo(client_fd);
+
+        if (init.resumable()) {
+            SessionResponse reply{};
+            if (sessions.enabled()) {
+                batch.session = sessions.create(client_fd, batch.n, batch.algorithm);
+                reply.setValues(batch.session->token, 0);
+            } else {
+                reply.setValues(0, 0);
+            }
+            reply.sendTo(client_fd);
+        }
+        return;
+    }
+
+    if (type != static_cast<uint32_t>(MessageType::ResumeRequest))
+        throw runtime_error("Unexpected message type " + to_string(type));
+
+    ResumeRequest resume;
+    resume.receiveFields(client_fd);
+    uint32_t received = ntohl(resume.Received);
+    batch.session = sessions.attach(be64toh(resume.Token), client_fd, received);
+
+    AckResponse ack{};
+    SessionResponse reply{};
+    watchdog.expectSend();
+    if (!batch.session) {
+        ack.setValues(MessageType::AckResponse, 0, HashAlgorithm::SHA256, true);
+        ack.sendTo(client_fd);
+        reply.setValues(0, 0);
+        reply.sendTo(client_fd);
+        throw runtime_error("Rejected ResumeRequest: unknown, expired or busy session");
+    }
+
+    resumable_session& session = *batch.session;
+    batch.n = session.n;
+    batch.next = session.next;
+    batch.algorithm = session.algorithm;
+
+    ack.setValues(MessageType::AckResponse, (batch.n - received)*40, batch.algorithm, true);
+    ack.sendTo(client_fd);
+    reply.setValues(session.token, batch.next);
+    reply.sendTo(client_fd);
+
+    for (uint32_t i = received; i < batch.next; ++i) {
+        HashResponse resp{};
+        resp.setValues(MessageType::HashResponse, i);
+        resp.Hash = session.digests[i - session.base];
+        watchdog.expectSend();
+        resp.sendTo(client_fd);
+    }
+}
+
+void HashService::handle_client(int client_fd) {
+    {
+        SessionWatchdog watchdog(timers, client_fd, options.deadlines);
+        batch_state batch;
+        bool delivered = false;
+        try {
+            watchdog.startBatch();
+            start_batch(client_fd, sessions, watchdog, batch);
+
+            for (uint32_t i = batch.next; i < batch.n; ++i) {
+                HashRequest req{};
+                HashResponse resp{};
+
+                resp.setValues(MessageType::HashResponse, i);
+                TRACE(trace_begin(i));
+                watchdog.expectHeader();
+                req.receiveHeader(client_fd);
+                TRACE(trace_mark(TracePoint::RecvStart));
+                resp.Hash = req.receivePayload(client_fd, options.salt, batch.algorithm, &watchdog);
+                if (batch.session)
+                    batch.session->record(resp.Hash, sessions.retained());
+                watchdog.expectSend();
+                resp.sendTo(client_fd);
+                TRACE(trace_end());
+            }
+
+            if (batch.session) {
+                // The client closes the connection once it holds every response
+                char byte;
+                watchdog.expectHeader();
+                delivered = recv(client_fd, &byte, 1, 0) == 0;
+            }
+        }
+        catch (const exception &ex) {
+            Eviction reason = watchdog.reason();
+            if (reason != Eviction::None)
+                cerr << "Evicted client: " << evictionName(reason) << " deadline expired ("
+                     << evictionCount(reason) << " " << evictionName(reason) << " evictions so far)\n";
+            else
+                cerr << "Error: " << ex.what() << "\n";
+        } catch (...) {
+            cerr << "Unknown error occurred\n";
+        }
+
+        if (batch.session)
+            sessions.release(batch.session, delivered);
+    }
+    close(client_fd);
+}
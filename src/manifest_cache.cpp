@@ -0,0 +1,119 @@
+#include "manifest_cache.h"
+#include "hasher.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstdio>
+
+using namespace std;
+
+string toHex(const array<uint8_t, 32>& digest) {
+    static const char digits[] = "0123456789abcdef";
+    string hex;
+    hex.reserve(digest.size() * 2);
+    for (uint8_t b : digest) {
+        hex.push_back(digits[b >> 4]);
+        hex.push_back(digits[b & 0xf]);
+    }
+    return hex;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+bool fromHex(const string& hex, array<uint8_t, 32>& out) {
+    if (hex.size() != out.size() * 2)
+        return false;
+    for (size_t i = 0; i < out.size(); ++i) {
+        int hi = hexValue(hex[2 * i]);
+        int lo = hexValue(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        out[i] = uint8_t(hi << 4 | lo);
+    }
+    return true;
+}
+
+void ManifestCache::load(const string& path) {
+    ifstream in(path);
+    if (!in)
+        return;
+
+    lock_guard<mutex> lock(mtx);
+    string line;
+    size_t number = 0;
+    while (getline(in, line)) {
+        ++number;
+        if (line.empty())
+            continue;
+
+        istringstream fields(line);
+        if (line.starts_with("server ")) {
+            string keyword, probeHex;
+            if (!(fields >> keyword >> server >> probeHex) || !fromHex(probeHex, probe))
+                throw runtime_error("Malformed manifest cache " + path + " at line " + to_string(number));
+            continue;
+        }
+
+        string name, fingerprint, digest;
+        HashAlgorithm algorithm;
+        Digest key, value;
+        if (!(fields >> name >> fingerprint >> digest) || !parseAlgorithm(name, algorithm)
+            || !fromHex(fingerprint, key) || !fromHex(digest, value))
+            throw runtime_error("Malformed manifest cache " + path + " at line " + to_string(number));
+
+        entries[{static_cast<uint32_t>(algorithm), key}] = value;
+    }
+}
+
+void ManifestCache::save(const string& path) const {
+    string tmp = path + ".tmp";
+    {
+        ofstream out(tmp, ios::trunc);
+        lock_guard<mutex> lock(mtx);
+        if (!server.empty())
+            out << "server " << server << " " << toHex(probe) << "\n";
+        for (const auto& [key, digest] : entries) {
+            out << algorithmName(static_cast<HashAlgorithm>(key.first)) << " "
+                << toHex(key.second) << " " << toHex(digest) << "\n";
+        }
+        if (!out.flush())
+            throw runtime_error("Failed to write manifest cache " + tmp);
+    }
+    if (rename(tmp.c_str(), path.c_str()) != 0)
+        throw runtime_error("Failed to replace manifest cache " + path);
+}
+
+bool ManifestCache::bind(const string& address, const Digest& digest) {
+    lock_guard<mutex> lock(mtx);
+    if (address == server && digest == probe)
+        return false;
+
+    bool dropped = !entries.empty();
+    entries.clear();
+    server = address;
+    probe = digest;
+    return dropped;
+}
+
+bool ManifestCache::lookup(HashAlgorithm algorithm, const Digest& fingerprint, Digest& digest) const {
+    lock_guard<mutex> lock(mtx);
+    auto it = entries.find({static_cast<uint32_t>(algorithm), fingerprint});
+    if (it == entries.end())
+        return false;
+    digest = it->second;
+    return true;
+}
+
+void ManifestCache::insert(HashAlgorithm algorithm, const Digest& fingerprint, const Digest& digest) {
+    lock_guard<mutex> lock(mtx);
+    entries[{static_cast<uint32_t>(algorithm), fingerprint}] = digest;
+}
@@ -1,4 +1,5 @@
 #include "parser_client.h"
+#include "hasher.h"
 
 #include <iostream>
 #include <cstring>
@@ -59,6 +60,33 @@ error_t client_parser(int key, char *arg, struct argp_state *state) {
 		if (args->smax > 1<<24)
 			argp_error(state, "The maximum size for the data payload (--smax), must be <= 2^24 (%d)", 1<<24);
 		break;
+	case 302: // algo
+		if (!parseAlgorithm(arg, args->algorithm))
+			argp_error(state, "Unknown hash algorithm (--algo), must be one of sha256, sha512-256, blake2s256");
+		break;
+	case 303: // path
+		args->path = arg;
+		break;
+	case 304: // manifest
+		args->manifest = arg;
+		break;
+	case 305: // resume
+		args->resume = true;
+		break;
+	case 306: // retries
+		if (!isNumber(arg) || *arg == '\0')
+			argp_error(state, "Invalid option for the number of retries (--retries), must be a number!");
+
+		args->retries = atoi(arg);
+		break;
+	case 'j':
+		if (!isNumber(arg) || *arg == '\0')
+			argp_error(state, "Invalid option for the number of jobs (-j --jobs), must be a number!");
+
+		args->jobs = atoi(arg);
+		if (args->jobs < 1)
+			argp_error(state, "The number of jobs (-j --jobs), must be >= 1");
+		break;
 	case 'f':
         args->filename = arg;
         args->file = fopen(arg, "r");
@@ -68,6 +96,21 @@ error_t client_parser(int key, char *arg, struct argp_state *state) {
             argp_error(state, "Option -a (--addr) is required!");
         if (args->addr.sin_port == 0)
             argp_error(state, "Option -p (--port) is required!");
+        if (args->path != "") {
+            if (args->hashnum != -1 || args->filename != "")
+                argp_error(state, "Option --path cannot be combined with -n (--hashreq) or -f (--file)");
+            if (args->resume)
+                argp_error(state, "Option --resume cannot be combined with --path");
+            if (args->smin == 0)
+                args->smin = 2048;
+            if (args->smax == 0)
+                args->smax = 65536;
+            if (args->smax < args->smin)
+                argp_error(state, "The maximum size for the data payload (--smax), must be greater or equal than the minimum size (--smin)");
+            break;
+        }
+        if (args->manifest != "")
+            argp_error(state, "Option --manifest requires --path");
         if (args->hashnum == -1)
             argp_error(state, "Option -n (--hashreq) is required!");
         if (args->smin == 0)
@@ -96,6 +139,12 @@ void client_parseopt(client_arguments& args, int argc, char *argv[]) {
 		{ "smin", 300, "minsize", 0, "The minimum size for the data payload in each hash request", 0},
 		{ "smax", 301, "maxsize", 0, "The maximum size for the data payload in each hash request", 0},
 		{ "file", 'f', "file", 0, "The file that the client reads data from for all hash requests", 0},
+		{ "path", 303, "path", 0, "A file or directory to fingerprint with content-defined chunks instead of -n/-f", 0},
+		{ "jobs", 'j', "jobs", 0, "The number of files hashed in parallel with --path. 4 by default", 0},
+		{ "manifest", 304, "file", 0, "A manifest cache; chunks already in it are not sent again (--path only)", 0},
+		{ "resume", 305, 0, 0, "Ask the server to retain the batch and resume it after a lost connection", 0},
+		{ "retries", 306, "retries", 0, "The number of reconnect attempts per request with --resume. 5 by default", 0},
+		{ "algo", 302, "algorithm", 0, "The digest algorithm the server should use (sha256, sha512-256, blake2s256). sha256 by default", 0},
 		{ 0, 0, 0, 0, 0, 0 }
 	};
 
@@ -104,6 +153,14 @@ void client_parseopt(client_arguments& args, int argc, char *argv[]) {
 	if (argp_parse(&argp_settings, argc, argv, 0, NULL, &args) != 0)
 		cout << "Got an error condition when parsing\n";
 
+	if (args.path != "") {
+		cout << "Got " << inet_ntoa(args.addr.sin_addr) << " on port " << ntohs(args.addr.sin_port) << " with path="
+			<< args.path << " smin=" << args.smin << " smax=" << args.smax << " jobs=" << args.jobs
+			<< " algo=" << algorithmName(args.algorithm) << "\n";
+		return;
+	}
+
 	cout << "Got " << inet_ntoa(args.addr.sin_addr) << " on port " << ntohs(args.addr.sin_port) << " with n="
-        << args.hashnum << " smin=" << args.smin << " smax=" << args.smax << " filename=" << args.filename << "\n";
+        << args.hashnum << " smin=" << args.smin << " smax=" << args.smax << " filename=" << args.filename
+        << " algo=" << algorithmName(args.algorithm) << "\n";
 }
@@ -33,6 +33,40 @@ error_t server_parser(int key, char *arg, struct argp_state *state) {
 		args->salt_len = strlen(arg);
 		args->salt = arg;
 		break;
+	case 300: // header-timeout
+		if (!isNumber(arg) || *arg == '\0')
+			argp_error(state, "Invalid option for the header timeout (--header-timeout), must be a number!");
+
+		args->header_timeout = atoi(arg);
+		break;
+	case 301: // min-rate
+		if (!isNumber(arg) || *arg == '\0')
+			argp_error(state, "Invalid option for the minimum payload rate (--min-rate), must be a number!");
+
+		args->min_rate = atoi(arg);
+		break;
+	case 302: // batch-timeout
+		if (!isNumber(arg) || *arg == '\0')
+			argp_error(state, "Invalid option for the batch timeout (--batch-timeout), must be a number!");
+
+		args->batch_timeout = atoi(arg);
+		break;
+	case 305: // resume-ttl
+		if (!isNumber(arg) || *arg == '\0')
+			argp_error(state, "Invalid option for the resume ttl (--resume-ttl), must be a number!");
+
+		args->resume_ttl = atoi(arg);
+		break;
+	case 303: // trace
+		args->trace_file = arg;
+		break;
+	case 304: { // trace-rate
+		char *end;
+		args->trace_rate = strtod(arg, &end);
+		if (*arg == '\0' || *end != '\0' || !(args->trace_rate > 0 && args->trace_rate <= 1))
+			argp_error(state, "Invalid option for the trace rate (--trace-rate), must be a number in (0, 1]!");
+		break;
+	}
     case ARGP_KEY_END:
         if (args->port == 0)
             argp_error(state, "Option -p (--port) is required!");
@@ -49,6 +83,12 @@ void server_parseopt(server_arguments& args, int argc, char *argv[]) {
 		struct argp_option options[] = {
 		{ "port", 'p', "port", 0, "The port to be used for the server", 0},
 		{ "salt", 's', "salt", 0, "The salt to be used for the server. Zero by default", 0},
+		{ "header-timeout", 300, "ms", 0, "Deadline for each message header and response. 30000 by default, 0 disables it", 0},
+		{ "min-rate", 301, "bytes/s", 0, "Minimum payload throughput before a client is evicted. 1024 by default, 0 disables it", 0},
+		{ "batch-timeout", 302, "seconds", 0, "Deadline for a whole client session. Disabled (0) by default", 0},
+		{ "resume-ttl", 305, "seconds", 0, "How long an interrupted resumable batch is kept for the client to resume. 60 by default, 0 disables resuming", 0},
+		{ "trace", 303, "file", 0, "Enable request tracing; send SIGUSR1 to write Chrome trace JSON to this file", 0},
+		{ "trace-rate", 304, "rate", 0, "Fraction of requests to trace when tracing is enabled. 1 by default", 0},
 		{ 0, 0, 0, 0, 0, 0 }
 	};
 
@@ -62,4 +102,8 @@ void server_parseopt(server_arguments& args, int argc, char *argv[]) {
         cout << "Got salt \"" << args.salt << "\" with length " << args.salt_len << "\n";
     else
         cout << "Salt was not provided\n";
+    cout << "Deadlines: header=" << args.header_timeout << "ms min-rate=" << args.min_rate
+        << "B/s batch=" << args.batch_timeout << "s resume-ttl=" << args.resume_ttl << "s\n";
+    if (args.trace_file != "")
+        cout << "Tracing " << args.trace_rate << " of requests to \"" << args.trace_file << "\" on SIGUSR1\n";
 }
\ No newline at end of file
@@ -1,7 +1,13 @@
 #include "requests.h"
 #include "hash.h"
+#include "hasher.h"
+#include "trace.h"
+#include "watchdog.h"
 
 #include <arpa/inet.h>
+#include <endian.h>
+#include <unistd.h>
+#include <cstring>
 #include <stdexcept>
 #include <algorithm>
 #include <cstdio>
@@ -12,7 +18,7 @@
 using namespace std;
 
 void sendAny(int sockfd, const void* data, ssize_t size, const char* errMsg) {
-    ssize_t sent = send(sockfd, data, size, 0);
+    ssize_t sent = send(sockfd, data, size, MSG_NOSIGNAL);
     if (sent != size)
         throw runtime_error(errMsg);
 }
@@ -30,47 +36,69 @@ void receiveAny(int sockfd, void* bytes_received, ssize_t size, const char* errM
     }
 }
 
-array<uint8_t, 32> receiveHash(int sockfd, ssize_t size, const string& salt, const char* errMsg) {
-    const ssize_t CHUNK = UPDATE_PAYLOAD_SIZE;
-    array<uint8_t, 32> digest{};
-    char buffer[CHUNK];
+int connectTo(const struct sockaddr_in& addr) {
+    int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sockfd < 0)
+        throw runtime_error(string("socket() failed: ") + strerror(errno));
+
+    if (connect(sockfd, (const struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        int err = errno;
+        close(sockfd);
+        throw runtime_error(string("connect() failed: ") + strerror(err));
+    }
+    return sockfd;
+}
+
+uint32_t receiveType(int sockfd) {
+    uint32_t type;
+    receiveAny(sockfd, &type, sizeof(type), "Receiving message type failed!");
+    return ntohl(type);
+}
 
-    const uint8_t* salt_ptr = salt.empty() ? nullptr
-                                           : reinterpret_cast<const uint8_t*>(salt.data());
+array<uint8_t, 32> receiveHash(int sockfd, ssize_t size, const string& salt, const char* errMsg,
+                               HashAlgorithm algorithm, SessionWatchdog* watchdog) {
+    const ssize_t CHUNK = UPDATE_PAYLOAD_SIZE;
+    uint8_t buffer[CHUNK];
+    Hasher hasher(salt, algorithm);
 
-    checksum_ctx* ctx = checksum_create(salt_ptr, salt.size());
-    if (!ctx)
-        throw runtime_error("Failed to create checksum context");
+    // Decided once per payload, so unsampled requests add no trace calls per chunk
+    bool sampled = false;
+    TRACE(sampled = trace_sampled());
 
     ssize_t total = 0;
+    ssize_t armed = 0; // bytes the current payload deadline covers
     while (total < size) {
+        if (watchdog && total >= armed) {
+            ssize_t slice = min<ssize_t>(PAYLOAD_DEADLINE_SLICE, size - total);
+            watchdog->expectPayload(slice);
+            armed = total + slice;
+        }
+
         ssize_t toRead = min(CHUNK, size - total);
         ssize_t received = recv(sockfd, buffer, toRead, 0);
-        if (received < 0) {
-            checksum_destroy(ctx);
+        if (received <= 0)
             throw runtime_error(errMsg);
-        }
 
         total += received;
-
-        if (total < size) {
-            if (checksum_update(ctx, reinterpret_cast<uint8_t*>(buffer)) != 0) {
-                checksum_destroy(ctx);
-                throw runtime_error("checksum_update failed");
-            }
+        if (__builtin_expect(sampled, 0)) {
+            trace_update_begin();
+            hasher.update(buffer, received);
+            trace_update_end();
         } else {
-            if (checksum_finish(ctx, reinterpret_cast<uint8_t*>(buffer), received, digest.data()) != 0) {
-                checksum_destroy(ctx);
-                throw runtime_error("checksum_finish failed");
-            }
+            hasher.update(buffer, received);
         }
     }
-    checksum_destroy(ctx);
+    TRACE(trace_mark(TracePoint::RecvComplete));
+    array<uint8_t, 32> digest = hasher.finish();
+    TRACE(trace_mark(TracePoint::HashComplete));
     return digest;
 }
 
-void InitRequest::setValues(int n) {
-    Type = htonl(static_cast<uint32_t>(MessageType::InitRequest));
+void InitRequest::setValues(int n, HashAlgorithm algorithm, bool resumable) {
+    uint32_t type = static_cast<uint32_t>(MessageType::InitRequest)
+                  | static_cast<uint32_t>(algorithm) << INIT_ALGORITHM_SHIFT
+                  | (resumable ? INIT_RESUMABLE : 0);
+    Type = htonl(type);
     N = htonl(n);
 }
 
@@ -81,11 +109,28 @@ void InitRequest::sendTo(int sockfd) const {
 
 void InitRequest::receive(int sockfd) {
     receiveAny(sockfd, &Type, sizeof(Type), ERR_RECV(InitRequest, Type));
+    receiveFields(sockfd);
+}
+
+void InitRequest::receiveFields(int sockfd) {
     receiveAny(sockfd, &N, sizeof(N), ERR_RECV(InitRequest, N));
 }
 
-void AckResponse::setValues(MessageType type, int length) {
-    Type = htonl(static_cast<uint32_t>(type));
+bool InitRequest::resumable() const {
+    return ntohl(Type) & INIT_RESUMABLE;
+}
+
+HashAlgorithm InitRequest::algorithm() const {
+    uint32_t value = (ntohl(Type) >> INIT_ALGORITHM_SHIFT) & INIT_ALGORITHM_MASK;
+    if (!isValidAlgorithm(value))
+        throw runtime_error("InitRequest asked for an unknown hash algorithm");
+    return static_cast<HashAlgorithm>(value);
+}
+
+void AckResponse::setValues(MessageType type, int length, HashAlgorithm algorithm, bool resumable) {
+    Type = htonl(static_cast<uint32_t>(type)
+                 | static_cast<uint32_t>(algorithm) << INIT_ALGORITHM_SHIFT
+                 | (resumable ? INIT_RESUMABLE : 0));
     Length = htonl(length);
 }
 
@@ -99,6 +144,17 @@ void AckResponse::receive(int sockfd) {
     receiveAny(sockfd, &Length, sizeof(Length), ERR_RECV(AckResponse, Length));
 }
 
+bool AckResponse::resumable() const {
+    return ntohl(Type) & INIT_RESUMABLE;
+}
+
+HashAlgorithm AckResponse::algorithm() const {
+    uint32_t value = (ntohl(Type) >> INIT_ALGORITHM_SHIFT) & INIT_ALGORITHM_MASK;
+    if (!isValidAlgorithm(value))
+        throw runtime_error("AckResponse named an unknown hash algorithm");
+    return static_cast<HashAlgorithm>(value);
+}
+
 void HashRequest::setValues(int length, FILE* file) {
     Type = htonl(static_cast<uint32_t>(MessageType::HashRequest));
     Length = htonl(length);
@@ -113,10 +169,32 @@ void HashRequest::sendTo(int sockfd) const {
     sendAny(sockfd, Payload.data(), Payload.size(), ERR_SEND(HashRequest, Payload));
 }
 
-array<uint8_t, 32> HashRequest::receive(int sockfd, const string& salt) {
+void HashRequest::setHeader(int length) {
+    Type = htonl(static_cast<uint32_t>(MessageType::HashRequest));
+    Length = htonl(length);
+}
+
+void HashRequest::sendTo(int sockfd, const uint8_t* payload) const {
+    sendAny(sockfd, &Type, sizeof(Type), ERR_SEND(HashRequest, Type));
+    sendAny(sockfd, &Length, sizeof(Length), ERR_SEND(HashRequest, Length));
+    sendAny(sockfd, payload, ntohl(Length), ERR_SEND(HashRequest, Payload));
+}
+
+array<uint8_t, 32> HashRequest::receive(int sockfd, const string& salt, HashAlgorithm algorithm) {
+    receiveHeader(sockfd);
+    return receivePayload(sockfd, salt, algorithm);
+}
+
+void HashRequest::receiveHeader(int sockfd) {
     receiveAny(sockfd, &Type, sizeof(Type), ERR_RECV(HashRequest, Type));
     receiveAny(sockfd, &Length, sizeof(Length), ERR_RECV(HashRequest, Length));
-    return receiveHash(sockfd, ntohl(Length), salt, ERR_RECV(HashRequest, Payload));
+    if (ntohl(Length) > MAX_PAYLOAD_SIZE)
+        throw runtime_error("HashRequest payload of " + to_string(ntohl(Length)) + " bytes exceeds the limit");
+}
+
+array<uint8_t, 32> HashRequest::receivePayload(int sockfd, const string& salt, HashAlgorithm algorithm,
+                                               SessionWatchdog* watchdog) {
+    return receiveHash(sockfd, ntohl(Length), salt, ERR_RECV(HashRequest, Payload), algorithm, watchdog);
 }
 
 void HashResponse::setValues(MessageType type, int i) {
@@ -134,4 +212,40 @@ void HashResponse::receive(int sockfd) {
     receiveAny(sockfd, &Type, sizeof(Type), ERR_RECV(HashResponse, Type));
     receiveAny(sockfd, &I, sizeof(I), ERR_RECV(HashResponse, Index));
     receiveAny(sockfd, &Hash, sizeof(Hash), ERR_RECV(HashResponse, Hash));
+}
+
+void ResumeRequest::setValues(uint64_t token, int received) {
+    Type = htonl(static_cast<uint32_t>(MessageType::ResumeRequest));
+    Token = htobe64(token);
+    Received = htonl(received);
+}
+
+void ResumeRequest::sendTo(int sockfd) const {
+    sendAny(sockfd, &Type, sizeof(Type), ERR_SEND(ResumeRequest, Type));
+    sendAny(sockfd, &Token, sizeof(Token), ERR_SEND(ResumeRequest, Token));
+    sendAny(sockfd, &Received, sizeof(Received), ERR_SEND(ResumeRequest, Received));
+}
+
+void ResumeRequest::receiveFields(int sockfd) {
+    Type = htonl(static_cast<uint32_t>(MessageType::ResumeRequest));
+    receiveAny(sockfd, &Token, sizeof(Token), ERR_RECV(ResumeRequest, Token));
+    receiveAny(sockfd, &Received, sizeof(Received), ERR_RECV(ResumeRequest, Received));
+}
+
+void SessionResponse::setValues(uint64_t token, int next) {
+    Type = htonl(static_cast<uint32_t>(MessageType::SessionResponse));
+    Token = htobe64(token);
+    Next = htonl(next);
+}
+
+void SessionResponse::sendTo(int sockfd) const {
+    sendAny(sockfd, &Type, sizeof(Type), ERR_SEND(SessionResponse, Type));
+    sendAny(sockfd, &Token, sizeof(Token), ERR_SEND(SessionResponse, Token));
+    sendAny(sockfd, &Next, sizeof(Next), ERR_SEND(SessionResponse, Next));
+}
+
+void SessionResponse::receive(int sockfd) {
+    receiveAny(sockfd, &Type, sizeof(Type), ERR_RECV(SessionResponse, Type));
+    receiveAny(sockfd, &Token, sizeof(Token), ERR_RECV(SessionResponse, Token));
+    receiveAny(sockfd, &Next, sizeof(Next), ERR_RECV(SessionResponse, Next));
 }
\ No newline at end of file
@@ -1,12 +1,13 @@
 #include "parser_server.h"
-#include "requests.h"
-#include "hash.h"
+#include "hash_service.h"
+#include "trace.h"
 
 #include <iostream>
 #include <cstring>
 #include <unistd.h>
 #include <thread>
 #include <arpa/inet.h>
+#include <csignal>
 
 using namespace std;
 
@@ -35,34 +36,20 @@ bool initializeSocket(server_arguments& args, int sockfd) {
     return false;
 }
 
-void handle_client(int client_fd, server_arguments args) {
-    try {
-        InitRequest init;
-        init.receive(client_fd);
-        int N = ntohl(init.N);
+void dump_trace_on_signal(string path) {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
 
-        AckResponse ack{};
-        ack.setValues(MessageType::AckResponse, N*40);
-        ack.sendTo(client_fd);
-
-        for (int i = 0; i < N; ++i) {
-            HashRequest req{};
-            HashResponse resp{};
-
-            resp.setValues(MessageType::HashResponse, i);
-            resp.Hash = req.receive(client_fd, args.salt);
-            resp.sendTo(client_fd);
-        }
+    int sig;
+    while (sigwait(&signals, &sig) == 0) {
+        if (trace_dump(path))
+            cout << "Wrote trace to " << path << "\n";
+        else
+            cerr << "Writing trace to " << path << " failed: " << strerror(errno) << "\n";
     }
-    catch (const exception &ex) {
-        cerr << "Error: " << ex.what() << "\n";
-    } catch (...) {
-        cerr << "Unknown error occurred\n";
-    }
-    close(client_fd);
 }
 
-
 int main(int argc, char *argv[]) {
     server_arguments args{};
     server_parseopt(args, argc, argv);
@@ -74,13 +61,31 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    if (args.trace_file != "") {
+        // Block SIGUSR1 before any thread starts so only the dumper receives it
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGUSR1);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+        trace_configure(args.trace_rate);
+        thread(dump_trace_on_signal, args.trace_file).detach();
+    }
+
+    service_options options;
+    options.salt = args.salt;
+    options.deadlines.header = chrono::milliseconds(args.header_timeout);
+    options.deadlines.min_rate = args.min_rate;
+    options.deadlines.batch = chrono::seconds(args.batch_timeout);
+    options.resume_ttl = chrono::seconds(args.resume_ttl);
+    HashService service(options);
+
     while (true) {
         int client_fd = accept(sockfd, nullptr, nullptr);
         if (client_fd < 0) {
             cerr << "accept() failed: " << strerror(errno) << "\n";
             continue;
         }
-        thread t(handle_client, client_fd, args);
-        t.detach();
+        service.serve(client_fd);
     }
 }
\ No newline at end of file
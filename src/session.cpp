@@ -0,0 +1,95 @@
+#include "session.h"
+
+#include <stdexcept>
+#include <openssl/rand.h>
+#include <sys/socket.h>
+
+using namespace std;
+
+void resumable_session::record(const array<uint8_t, 32>& digest, size_t window) {
+    digests.push_back(digest);
+    ++next;
+    while (digests.size() > window) {
+        digests.pop_front();
+        ++base;
+    }
+}
+
+SessionStore::SessionStore(TimerWheel& wheel, chrono::seconds ttl, size_t window, size_t max_parked)
+    : wheel(wheel), ttl(ttl), window(window), max_parked(max_parked) {}
+
+shared_ptr<resumable_session> SessionStore::create(int sockfd, uint32_t n, HashAlgorithm algorithm) {
+    auto session = make_shared<resumable_session>();
+    session->n = n;
+    session->algorithm = algorithm;
+    session->sockfd = sockfd;
+
+    lock_guard<mutex> lock(mtx);
+    do {
+        if (RAND_bytes(reinterpret_cast<unsigned char*>(&session->token), sizeof(session->token)) != 1)
+            throw runtime_error("Failed to generate a session token");
+    } while (session->token == 0 || sessions.count(session->token));
+
+    sessions.emplace(session->token, session);
+    return session;
+}
+
+shared_ptr<resumable_session> SessionStore::attach(uint64_t token, int sockfd, uint32_t received) {
+    lock_guard<mutex> lock(mtx);
+    auto it = sessions.find(token);
+    if (it == sessions.end())
+        return nullptr;
+
+    shared_ptr<resumable_session> session = it->second;
+    if (session->sockfd >= 0) {
+        // The old connection may be half-open; make its thread give the
+        // session up, and park it rather than treat the shutdown as EOF
+        session->taken_over = true;
+        shutdown(session->sockfd, SHUT_RDWR);
+        return nullptr;
+    }
+    if (received < session->base || received > session->next)
+        return nullptr;
+
+    while (session->base < received) {
+        session->digests.pop_front();
+        ++session->base;
+    }
+    parked.erase(session->parked_at);
+    session->sockfd = sockfd;
+    return session;
+}
+
+void SessionStore::release(const shared_ptr<resumable_session>& session, bool delivered) {
+    lock_guard<mutex> lock(mtx);
+    session->sockfd = -1;
+    uint64_t generation = ++session->generation;
+    bool taken_over = session->taken_over;
+    session->taken_over = false;
+
+    if (delivered && !taken_over) {
+        sessions.erase(session->token);
+        return;
+    }
+
+    // Make room by dropping the oldest parked session
+    if (!parked.empty() && parked.size() >= max_parked) {
+        auto oldest = parked.begin();
+        sessions.erase(oldest->second);
+        parked.erase(oldest);
+    }
+    session->parked_at = ++parks;
+    parked.emplace(session->parked_at, session->token);
+
+    uint64_t token = session->token;
+    wheel.schedule(ttl, [this, token, generation] { expire(token, generation); });
+}
+
+void SessionStore::expire(uint64_t token, uint64_t generation) {
+    lock_guard<mutex> lock(mtx);
+    auto it = sessions.find(token);
+    if (it != sessions.end() && it->second->sockfd < 0 && it->second->generation == generation) {
+        parked.erase(it->second->parked_at);
+        sessions.erase(it);
+    }
+}
@@ -0,0 +1,110 @@
+#include "timer_wheel.h"
+
+#include <vector>
+
+using namespace std;
+
+static constexpr uint64_t WHEEL_SPAN = uint64_t(1) << (TimerWheel::SLOT_BITS * TimerWheel::LEVELS);
+
+TimerWheel::TimerWheel(Clock::duration tick) : start(Clock::now()), tick(tick) {}
+
+TimerWheel::~TimerWheel() {
+    for (auto& [id, timer] : timers)
+        delete timer;
+}
+
+void TimerWheel::link(Timer* timer) {
+    uint64_t delta = timer->expires - current;
+    unsigned level = 0;
+    while (level + 1 < LEVELS && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1))))
+        ++level;
+
+    unsigned slot = (timer->expires >> (SLOT_BITS * level)) & (SLOTS - 1);
+    Timer** bucket = &wheel[level][slot];
+
+    timer->bucket = bucket;
+    timer->prev = nullptr;
+    timer->next = *bucket;
+    if (*bucket)
+        (*bucket)->prev = timer;
+    *bucket = timer;
+}
+
+void TimerWheel::unlink(Timer* timer) {
+    if (timer->prev)
+        timer->prev->next = timer->next;
+    else
+        *timer->bucket = timer->next;
+    if (timer->next)
+        timer->next->prev = timer->prev;
+    timer->prev = timer->next = nullptr;
+    timer->bucket = nullptr;
+}
+
+TimerWheel::TimerId TimerWheel::schedule(Clock::duration delay, Callback cb) {
+    lock_guard<mutex> lock(mtx);
+
+    uint64_t ticks = delay <= Clock::duration::zero() ? 1 : (delay + tick - Clock::duration(1)) / tick;
+    if (ticks >= WHEEL_SPAN)
+        ticks = WHEEL_SPAN - 1;
+
+    Timer* timer = new Timer{nextId++, current + ticks, std::move(cb)};
+    timers.emplace(timer->id, timer);
+    link(timer);
+    return timer->id;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    lock_guard<mutex> lock(mtx);
+
+    auto it = timers.find(id);
+    if (it == timers.end())
+        return false;
+
+    unlink(it->second);
+    delete it->second;
+    timers.erase(it);
+    return true;
+}
+
+size_t TimerWheel::advance(Clock::time_point now) {
+    vector<Callback> expired;
+    {
+        lock_guard<mutex> lock(mtx);
+
+        uint64_t target = now <= start ? 0 : uint64_t((now - start) / tick);
+        while (current < target) {
+            ++current;
+
+            // Cascade every higher level whose bucket boundary we just crossed
+            for (unsigned level = 1; level < LEVELS; ++level) {
+                if (current & ((uint64_t(1) << (SLOT_BITS * level)) - 1))
+                    break;
+
+                unsigned slot = (current >> (SLOT_BITS * level)) & (SLOTS - 1);
+                Timer* timer = wheel[level][slot];
+                wheel[level][slot] = nullptr;
+                while (timer) {
+                    Timer* next = timer->next;
+                    link(timer);
+                    timer = next;
+                }
+            }
+
+            Timer** bucket = &wheel[0][current & (SLOTS - 1)];
+            Timer* timer = *bucket;
+            *bucket = nullptr;
+            while (timer) {
+                Timer* next = timer->next;
+                expired.push_back(std::move(timer->cb));
+                timers.erase(timer->id);
+                delete timer;
+                timer = next;
+            }
+        }
+    }
+
+    for (Callback& cb : expired)
+        cb();
+    return expired.size();
+}
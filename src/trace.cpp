@@ -0,0 +1,222 @@
+#include "trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+bool trace_enabled = false;
+
+static constexpr size_t RING_SIZE = 1024;
+static constexpr unsigned POINTS = 5;
+
+/* One published span. seq is odd while the owner thread rewrites the
+ * slot, and 2 * (position + 1) once the slot holds the span published at
+ * that ring position; readers use it to skip torn or stale slots. */
+struct TraceSlot {
+    atomic<uint64_t> seq{0};
+    atomic<uint32_t> index{0};
+    atomic<uint64_t> at[POINTS]{};
+    atomic<uint64_t> hashing{0};
+};
+
+/* Single-producer ring; only its owner thread writes, trace_dump reads */
+struct TraceRing {
+    uint32_t id;
+    atomic<uint64_t> head{0};
+    TraceSlot slots[RING_SIZE];
+};
+
+static uint64_t sample_threshold = 0;
+
+static mutex registry_mtx;
+static vector<unique_ptr<TraceRing>> rings;
+static vector<TraceRing*> free_rings;
+
+/* Hands out a ring for the calling thread and returns it to the free
+ * list when the thread exits, so one-thread-per-client servers reuse a
+ * bounded number of rings. Published spans stay in the ring for dumps. */
+struct RingLease {
+    TraceRing* ring = nullptr;
+
+    TraceRing* get() {
+        if (!ring) {
+            lock_guard<mutex> lock(registry_mtx);
+            if (!free_rings.empty()) {
+                ring = free_rings.back();
+                free_rings.pop_back();
+            } else {
+                rings.push_back(make_unique<TraceRing>());
+                ring = rings.back().get();
+                ring->id = rings.size();
+            }
+        }
+        return ring;
+    }
+
+    ~RingLease() {
+        if (ring) {
+            lock_guard<mutex> lock(registry_mtx);
+            free_rings.push_back(ring);
+        }
+    }
+};
+
+/* Span being recorded by the calling thread */
+struct ActiveSpan {
+    bool sampled = false;
+    uint32_t index = 0;
+    uint64_t at[POINTS] = {};
+    uint64_t update_start = 0;
+    uint64_t hashing = 0; // ns spent in digest updates
+};
+
+static thread_local RingLease lease;
+static thread_local ActiveSpan span;
+static thread_local uint64_t rng_state = 0;
+
+static uint64_t now_ns() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* xorshift64*, seeded per thread from its own address and the clock */
+static uint64_t next_random() {
+    if (rng_state == 0)
+        rng_state = (reinterpret_cast<uintptr_t>(&rng_state) ^ now_ns()) | 1;
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+void trace_configure(double rate) {
+    if (rate <= 0) {
+        trace_enabled = false;
+        return;
+    }
+    sample_threshold = rate >= 1 ? UINT64_MAX : static_cast<uint64_t>(rate * 18446744073709551616.0);
+    trace_enabled = true;
+}
+
+void trace_begin(uint32_t index) {
+    span.sampled = sample_threshold == UINT64_MAX || next_random() < sample_threshold;
+    if (!span.sampled)
+        return;
+
+    span.index = index;
+    span.at[static_cast<unsigned>(TracePoint::WaitStart)] = now_ns();
+    for (unsigned i = 1; i < POINTS; ++i)
+        span.at[i] = 0;
+    span.hashing = 0;
+}
+
+void trace_mark(TracePoint point) {
+    if (span.sampled)
+        span.at[static_cast<unsigned>(point)] = now_ns();
+}
+
+bool trace_sampled() {
+    return span.sampled;
+}
+
+void trace_update_begin() {
+    span.update_start = now_ns();
+}
+
+void trace_update_end() {
+    span.hashing += now_ns() - span.update_start;
+}
+
+void trace_end() {
+    if (!span.sampled)
+        return;
+    span.sampled = false;
+    span.at[static_cast<unsigned>(TracePoint::SendComplete)] = now_ns();
+
+    // Points a request never reached (e.g. empty payloads) collapse onto the previous one
+    for (unsigned i = 1; i < POINTS; ++i) {
+        if (span.at[i] == 0)
+            span.at[i] = span.at[i - 1];
+    }
+
+    TraceRing* ring = lease.get();
+    uint64_t position = ring->head.load(memory_order_relaxed);
+    TraceSlot& slot = ring->slots[position % RING_SIZE];
+
+    slot.seq.store(2 * position + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot.index.store(span.index, memory_order_relaxed);
+    for (unsigned i = 0; i < POINTS; ++i)
+        slot.at[i].store(span.at[i], memory_order_relaxed);
+    slot.hashing.store(span.hashing, memory_order_relaxed);
+    slot.seq.store(2 * position + 2, memory_order_release);
+    ring->head.store(position + 1, memory_order_release);
+}
+
+static void write_event(FILE* out, bool& first, const char* name, uint32_t tid, uint32_t index,
+                        uint64_t from, uint64_t to) {
+    fprintf(out, "%s\n{\"name\":\"%s\",\"cat\":\"request\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                 "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"index\":%u}}",
+            first ? "" : ",", name, tid, from / 1000.0, (to - from) / 1000.0, index);
+    first = false;
+}
+
+/* The recv slice also reports how much of it was spent hashing */
+static void write_recv_event(FILE* out, bool& first, uint32_t tid, uint32_t index,
+                             uint64_t from, uint64_t to, uint64_t hashing) {
+    fprintf(out, "%s\n{\"name\":\"recv\",\"cat\":\"request\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                 "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"index\":%u,\"hashing_us\":%.3f}}",
+            first ? "" : ",", tid, from / 1000.0, (to - from) / 1000.0, index, hashing / 1000.0);
+    first = false;
+}
+
+bool trace_dump(const string& path) {
+    string tmp = path + ".tmp";
+    FILE* out = fopen(tmp.c_str(), "w");
+    if (!out)
+        return false;
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool first = true;
+    {
+        lock_guard<mutex> lock(registry_mtx);
+        for (const auto& ring : rings) {
+            fprintf(out, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                         "\"args\":{\"name\":\"session thread %u\"}}",
+                    first ? "" : ",", ring->id, ring->id);
+            first = false;
+
+            uint64_t head = ring->head.load(memory_order_acquire);
+            uint64_t position = head > RING_SIZE ? head - RING_SIZE : 0;
+            for (; position < head; ++position) {
+                const TraceSlot& slot = ring->slots[position % RING_SIZE];
+                uint64_t seq = slot.seq.load(memory_order_acquire);
+                if (seq != 2 * position + 2)
+                    continue;
+
+                uint32_t index = slot.index.load(memory_order_relaxed);
+                uint64_t at[POINTS];
+                for (unsigned i = 0; i < POINTS; ++i)
+                    at[i] = slot.at[i].load(memory_order_relaxed);
+                uint64_t hashing = slot.hashing.load(memory_order_relaxed);
+                atomic_thread_fence(memory_order_acquire);
+                if (slot.seq.load(memory_order_relaxed) != seq)
+                    continue;
+
+                write_event(out, first, "wait", ring->id, index, at[0], at[1]);
+                write_event(out, first, "request", ring->id, index, at[1], at[4]);
+                write_recv_event(out, first, ring->id, index, at[1], at[2], hashing);
+                write_event(out, first, "hash", ring->id, index, at[2], at[3]);
+                write_event(out, first, "send", ring->id, index, at[3], at[4]);
+            }
+        }
+    }
+    fprintf(out, "\n]}\n");
+
+    bool ok = fclose(out) == 0;
+    return ok && rename(tmp.c_str(), path.c_str()) == 0;
+}
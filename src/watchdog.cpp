@@ -0,0 +1,90 @@
+#include "watchdog.h"
+
+#include <sys/socket.h>
+
+using namespace std;
+
+static atomic<uint64_t> evictions[5];
+
+const char* evictionName(Eviction reason) {
+    switch (reason) {
+    case Eviction::None:
+        return "none";
+    case Eviction::Header:
+        return "header";
+    case Eviction::Payload:
+        return "payload";
+    case Eviction::Send:
+        return "send";
+    case Eviction::Batch:
+        return "batch";
+    }
+    return "unknown";
+}
+
+uint64_t evictionCount(Eviction reason) {
+    return evictions[static_cast<unsigned>(reason)].load(memory_order_relaxed);
+}
+
+SessionWatchdog::SessionWatchdog(TimerWheel& wheel, int sockfd, const deadline_settings& settings)
+    : wheel(wheel), settings(settings), state(make_shared<State>()) {
+    state->sockfd = sockfd;
+}
+
+SessionWatchdog::~SessionWatchdog() {
+    disarm(ioTimer);
+    disarm(batchTimer);
+
+    // A timer that already left the wheel may still be about to run
+    lock_guard<mutex> lock(state->mtx);
+    state->sockfd = -1;
+}
+
+void SessionWatchdog::arm(TimerWheel::TimerId& timer, chrono::milliseconds delay, Eviction reason) {
+    disarm(timer);
+    if (delay <= chrono::milliseconds::zero())
+        return;
+
+    shared_ptr<State> target = state;
+    timer = wheel.schedule(delay, [target, reason] {
+        lock_guard<mutex> lock(target->mtx);
+        if (target->sockfd < 0 || target->reason.load() != Eviction::None)
+            return;
+
+        target->reason.store(reason);
+        evictions[static_cast<unsigned>(reason)].fetch_add(1, memory_order_relaxed);
+        shutdown(target->sockfd, SHUT_RDWR);
+    });
+}
+
+void SessionWatchdog::disarm(TimerWheel::TimerId& timer) {
+    if (timer) {
+        wheel.cancel(timer);
+        timer = 0;
+    }
+}
+
+void SessionWatchdog::expectHeader() {
+    arm(ioTimer, settings.header, Eviction::Header);
+}
+
+void SessionWatchdog::expectPayload(size_t length) {
+    if (settings.min_rate == 0) {
+        disarm(ioTimer);
+        return;
+    }
+    chrono::milliseconds transfer(length * 1000 / settings.min_rate);
+    arm(ioTimer, settings.header + transfer, Eviction::Payload);
+}
+
+void SessionWatchdog::expectSend() {
+    arm(ioTimer, settings.header, Eviction::Send);
+}
+
+void SessionWatchdog::startBatch() {
+    arm(batchTimer, settings.batch, Eviction::Batch);
+}
+
+Eviction SessionWatchdog::reason() const {
+    return state->reason.load();
+}
@@ -0,0 +1,69 @@
+#include "worker_pool.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+WorkerPool::WorkerPool(size_t keep, chrono::seconds idle_timeout) : keep(keep), idle_timeout(idle_timeout) {}
+
+WorkerPool::~WorkerPool() {
+    unique_lock<mutex> lock(mtx);
+    stopping = true;
+    wake.notify_all();
+    exited.wait(lock, [&] { return threads == 0; });
+}
+
+void WorkerPool::post(function<void()> job) {
+    lock_guard<mutex> lock(mtx);
+    if (stopping)
+        throw runtime_error("WorkerPool is shutting down");
+
+    jobs.push_back(std::move(job));
+    // Idle workers that were woken but have not picked a job yet still
+    // count as idle, so compare against every queued job
+    if (jobs.size() > idle) {
+        try {
+            thread(&WorkerPool::work, this).detach();
+        } catch (...) {
+            jobs.pop_back();
+            throw;
+        }
+        ++threads;
+    } else {
+        wake.notify_one();
+    }
+}
+
+void WorkerPool::work() {
+    unique_lock<mutex> lock(mtx);
+    while (true) {
+        if (jobs.empty()) {
+            if (stopping)
+                break;
+
+            ++idle;
+            bool ready = wake.wait_for(lock, idle_timeout, [&] { return !jobs.empty() || stopping; });
+            --idle;
+            if (!ready && threads > keep)
+                break;
+            continue;
+        }
+
+        function<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        try {
+            job();
+        } catch (const exception &ex) {
+            cerr << "Error: " << ex.what() << "\n";
+        } catch (...) {
+            cerr << "Unknown error occurred\n";
+        }
+        lock.lock();
+    }
+
+    --threads;
+    exited.notify_all();
+}